@@ -0,0 +1,46 @@
+// Сравнение скорости вывода: iostream (operator<<) против FormatBuffer/to_chars
+// bench_dump [N] [threads]
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include "figure_array.h"
+#include "scene_generator.h"
+
+using D = double;
+
+template <class Fn>
+static double timeIt(Fn fn) {
+    auto t0 = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    unsigned threads = argc > 2 ? std::atoi(argv[2]) : 4;
+
+    SceneOptions opt;
+    opt.scale = 0.125;
+    Array<std::shared_ptr<Figure<D>>> figs = SceneGenerator<D>(opt).scene(n);
+
+    std::ofstream sink("/dev/null");
+    double tOld = timeIt([&] {
+        for (size_t i = 0; i < figs.size(); ++i)
+            sink << i << ": " << *figs[i] << " Area = " << double(*figs[i]) << "\n";
+        sink.flush();
+    });
+    double tText = timeIt([&] { figs.printAll(sink); sink.flush(); });
+    double tPar  = timeIt([&] { figs.printAll(sink, DumpFormat::Text, threads); sink.flush(); });
+    double tCsv  = timeIt([&] { figs.printAll(sink, DumpFormat::Csv); sink.flush(); });
+    double tJson = timeIt([&] { figs.printAll(sink, DumpFormat::JsonLines); sink.flush(); });
+
+    std::cout << "figures: " << n << "\n";
+    std::cout << "iostream:          " << tOld << " ms\n";
+    std::cout << "to_chars text:     " << tText << " ms\n";
+    std::cout << "to_chars text x" << threads << ":  " << tPar << " ms\n";
+    std::cout << "to_chars csv:      " << tCsv << " ms\n";
+    std::cout << "to_chars json:     " << tJson << " ms\n";
+    return 0;
+}
@@ -0,0 +1,49 @@
+// Масштабирование шардированной сцены по числу процессов
+// bench_shards [N] [max_workers] [repeat]
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include "scene_generator.h"
+#include "sharded_scene.h"
+
+using D = double;
+
+template <class Fn>
+static double timeIt(unsigned repeat, Fn fn) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (unsigned r = 0; r < repeat; ++r) fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() / repeat;
+}
+
+static bool smallFigure(const Figure<D>& f) {
+    return f.area() < 4.0;
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    unsigned maxWorkers = argc > 2 ? std::atoi(argv[2]) : 8;
+    unsigned repeat = argc > 3 ? std::atoi(argv[3]) : 5;
+
+    SceneOptions opt;
+    opt.extent = 10000;
+    opt.placement = Placement::Clustered;
+    opt.clusters = 64;
+    opt.clusterSpread = 500.0;
+    auto figs = SceneGenerator<D>(opt).scene(n);
+
+    std::cout << "figures: " << n << "\n";
+    std::cout << "workers  load ms  totalArea ms  countInBox ms  eraseIf ms\n";
+    for (unsigned w = 1; w <= maxWorkers; w *= 2) {
+        ShardedScene<D> scene(w, ShardBy::Cell, 500.0);
+        double tLoad = timeIt(1, [&] { scene.insert(figs); scene.flush(); scene.size(); });
+
+        volatile double sink = 0.0;
+        double tArea = timeIt(repeat, [&] { sink = scene.totalArea(); });
+        double tBox = timeIt(repeat, [&] { sink = double(scene.countInBox(-2500.0, -2500.0, 2500.0, 2500.0)); });
+        double tErase = timeIt(1, [&] { sink = double(scene.eraseIf(&smallFigure)); });
+
+        std::cout << w << "        " << tLoad << "  " << tArea << "  " << tBox << "  " << tErase << "\n";
+    }
+    return 0;
+}
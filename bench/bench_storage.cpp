@@ -0,0 +1,65 @@
+// Память и скорость totalArea: Array<shared_ptr<Figure<double>>> против PackedScene
+// bench_storage [N] [repeat]
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <malloc.h>
+#include <memory>
+#include "figure_array.h"
+#include "packed_scene.h"
+#include "scene_generator.h"
+
+using D = double;
+
+// Занятая куча, включая крупные блоки, выделенные через mmap
+static size_t heapInUse() {
+    auto mi = mallinfo2();
+    return mi.uordblks + mi.hblkhd;
+}
+
+template <class Fn>
+static double timeIt(unsigned repeat, Fn fn) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (unsigned r = 0; r < repeat; ++r) fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() / repeat;
+}
+
+template <PackedCoord C>
+static void runPacked(const char* label, const Array<std::shared_ptr<Figure<D>>>& figs,
+                      unsigned repeat, double exact) {
+    size_t before = heapInUse();
+    auto packed = PackedScene<C>::from(figs, 1e-3);
+    size_t heap = heapInUse() - before;
+
+    volatile double sink = 0.0;
+    typename PackedScene<C>::Estimate est;
+    double ms = timeIt(repeat, [&] { est = packed.totalArea(); sink = est.value; });
+    std::cout << label << heap / double(figs.size()) << " B/figure, totalArea "
+              << ms << " ms, |err| = " << std::abs(est.value - exact)
+              << " <= bound " << est.error << "\n";
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    unsigned repeat = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    size_t before = heapInUse();
+    SceneOptions opt;
+    opt.extent = 20000;
+    opt.placement = Placement::Clustered;
+    opt.scale = 0.125;
+    Array<std::shared_ptr<Figure<D>>> figs = SceneGenerator<D>(opt).scene(n);
+    size_t heap = heapInUse() - before;
+
+    volatile double sink = 0.0;
+    double exact = figs.totalArea();
+    double ms = timeIt(repeat, [&] { sink = figs.totalArea(); });
+
+    std::cout << "figures: " << n << "\n";
+    std::cout << "double/shared_ptr: " << heap / double(n) << " B/figure, totalArea " << ms << " ms\n";
+    runPacked<float>("packed float:      ", figs, repeat, exact);
+    runPacked<std::int32_t>("packed int32:      ", figs, repeat, exact);
+    runPacked<std::int16_t>("packed int16:      ", figs, repeat, exact);
+    return 0;
+}
@@ -0,0 +1,279 @@
+#pragma once
+#include "concepts.h"
+#include "figure.h"
+#include "figure_array.h"
+#include "figure_io.h"
+#include "scene_generator.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// --- Пакетный (неинтерактивный) режим ---
+//
+// main --input figs.txt --ops ops.txt --output out.txt --threads 4 --repeat 10
+//      [--format text|csv|json]
+//
+// Операции (по одной на строку в --ops или через -e):
+//   add <kind> x1 y1 x2 y2 ...     — формат строки как во входном файле
+//   erase <idx>
+//   area                    — суммарная площадь
+//   centers                 — центры всех фигур
+//   print                   — все фигуры с площадями
+//   query x0 y0 x1 y1       — индексы фигур с центром в прямоугольнике
+//   count
+//   generate <n> [seed]     — добавить n случайных фигур (SceneGenerator)
+//   stats                   — агрегаты сцены (по видам, габариты, центр масс)
+//   save <file>             — сохранить коллекцию в бинарном формате
+//
+// Ошибка операции пишется в вывод ("error: ..."), выполнение продолжается;
+// код возврата — 1, если хоть одна операция завершилась ошибкой.
+struct BatchOptions {
+    std::string input;
+    bool inputBinary{false};
+    std::string ops;
+    std::vector<std::string> inlineOps;
+    std::string output;
+    unsigned threads{1};
+    unsigned repeat{1};
+    bool timing{false};
+    DumpFormat format{DumpFormat::Text};
+};
+
+inline void batchUsage(std::ostream& os) {
+    os << "usage: main [--input FILE | --binary FILE] [--ops FILE] [-e OP]...\n"
+          "            [--output FILE] [--format text|csv|json]\n"
+          "            [--threads N] [--repeat N] [--time]\n";
+}
+
+inline BatchOptions parseBatchArgs(int argc, char** argv) {
+    BatchOptions o;
+    auto need = [&](int& i) -> std::string {
+        if (i + 1 >= argc) throw std::invalid_argument(std::string("missing value for ") + argv[i]);
+        return argv[++i];
+    };
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--input") o.input = need(i);
+        else if (a == "--binary") { o.input = need(i); o.inputBinary = true; }
+        else if (a == "--ops") o.ops = need(i);
+        else if (a == "-e") o.inlineOps.push_back(need(i));
+        else if (a == "--output") o.output = need(i);
+        else if (a == "--threads") o.threads = std::max(1, std::stoi(need(i)));
+        else if (a == "--repeat") o.repeat = std::max(1, std::stoi(need(i)));
+        else if (a == "--time") o.timing = true;
+        else if (a == "--format") {
+            std::string f = need(i);
+            if (f == "text") o.format = DumpFormat::Text;
+            else if (f == "csv") o.format = DumpFormat::Csv;
+            else if (f == "json") o.format = DumpFormat::JsonLines;
+            else throw std::invalid_argument("unknown format: " + f);
+        }
+        else throw std::invalid_argument("unknown option: " + a);
+    }
+    return o;
+}
+
+// Делит [0, n) на threads отрезков и вызывает fn(begin, end, k) для каждого
+template <class Fn>
+void parallelChunks(size_t n, unsigned threads, Fn fn) {
+    if (threads <= 1 || n < 2 * threads) {
+        fn(size_t{0}, n, 0u);
+        return;
+    }
+    std::vector<std::thread> pool;
+    size_t chunk = (n + threads - 1) / threads;
+    for (unsigned k = 0; k < threads; ++k) {
+        size_t b = k * chunk, e = std::min(n, b + chunk);
+        if (b >= e) break;
+        pool.emplace_back(fn, b, e, k);
+    }
+    for (auto& t : pool) t.join();
+}
+
+template <Scalar T>
+double parallelTotalArea(const Array<std::shared_ptr<Figure<T>>>& figs, unsigned threads) {
+    std::vector<double> part(threads, 0.0);
+    parallelChunks(figs.size(), threads, [&](size_t b, size_t e, unsigned k) {
+        double s = 0.0;
+        for (size_t i = b; i < e; ++i) s += figs[i]->area();
+        part[k] = s;
+    });
+    double sum = 0.0;
+    for (double s : part) sum += s;
+    return sum;
+}
+
+template <Scalar T>
+std::vector<size_t> parallelQuery(const Array<std::shared_ptr<Figure<T>>>& figs, unsigned threads,
+                                  double x0, double y0, double x1, double y1) {
+    std::vector<std::vector<size_t>> part(threads);
+    parallelChunks(figs.size(), threads, [&](size_t b, size_t e, unsigned k) {
+        for (size_t i = b; i < e; ++i) {
+            auto c = figs[i]->center();
+            if (c.x >= x0 && c.x <= x1 && c.y >= y0 && c.y <= y1) part[k].push_back(i);
+        }
+    });
+    std::vector<size_t> res;
+    for (auto& p : part) res.insert(res.end(), p.begin(), p.end());
+    return res;
+}
+
+template <Scalar T>
+class BatchRunner {
+private:
+    struct OpStat {
+        size_t calls{0};
+        double seconds{0.0};
+    };
+
+    const BatchOptions& opt_;
+    Array<std::shared_ptr<Figure<T>>>& figs_;
+    std::shared_ptr<VertexPool<T>> pool_;
+    std::ostringstream out_;
+    std::map<std::string, OpStat> stats_;
+    size_t errors_{0};
+
+    void run(const std::string& line) {
+        std::istringstream ls(line);
+        std::string op;
+        ls >> op;
+
+        if (op == "add") {
+            std::string rest;
+            std::getline(ls, rest);
+            figs_.push_back(std::shared_ptr<Figure<T>>(parseFigure<T>(rest, pool_)));
+        } else if (op == "erase") {
+            size_t idx;
+            if (!(ls >> idx)) throw std::invalid_argument("erase: index expected");
+            figs_.erase(idx);
+        } else if (op == "area") {
+            out_ << "total area = " << parallelTotalArea(figs_, opt_.threads) << "\n";
+        } else if (op == "centers") {
+            figs_.printCenters(out_, opt_.format, opt_.threads);
+        } else if (op == "print") {
+            figs_.printAll(out_, opt_.format, opt_.threads);
+        } else if (op == "query") {
+            double x0, y0, x1, y1;
+            if (!(ls >> x0 >> y0 >> x1 >> y1)) throw std::invalid_argument("query: 4 numbers expected");
+            auto hits = parallelQuery(figs_, opt_.threads, x0, y0, x1, y1);
+            out_ << "query hits = " << hits.size() << ":";
+            for (size_t i : hits) out_ << " " << i;
+            out_ << "\n";
+        } else if (op == "count") {
+            out_ << "count = " << figs_.size() << "\n";
+        } else if (op == "generate") {
+            size_t n = 0;
+            SceneOptions so;
+            if (!(ls >> n)) throw std::invalid_argument("generate: count expected");
+            ls >> so.seed;
+            SceneGenerator<T> gen(so);
+            for (size_t i = 0; i < n; ++i) figs_.push_back(gen.next().figure);
+        } else if (op == "stats") {
+            out_ << figs_.stats();
+        } else if (op == "save") {
+            std::string path;
+            ls >> path;
+            std::ofstream f(path, std::ios::binary);
+            if (!f) throw std::runtime_error("cannot open " + path);
+            for (size_t i = 0; i < figs_.size(); ++i) writeBinary(f, *figs_[i]);
+        } else {
+            throw std::invalid_argument("unknown op: " + op);
+        }
+    }
+
+public:
+    // Многоугольники из add кладутся в pool — тот же, что у загруженных фигур
+    BatchRunner(const BatchOptions& opt, Array<std::shared_ptr<Figure<T>>>& figs,
+                std::shared_ptr<VertexPool<T>> pool)
+        : opt_(opt), figs_(figs), pool_(std::move(pool)) {}
+
+    // Выполняет одну операцию с замером времени; ошибки пишутся в вывод
+    void execute(const std::string& line) {
+        if (line.empty() || line[0] == '#') return;
+        std::string op = line.substr(0, line.find(' '));
+        auto t0 = std::chrono::steady_clock::now();
+        try {
+            run(line);
+        } catch (const std::exception& e) {
+            out_ << "error: " << e.what() << "\n";
+            ++errors_;
+        }
+        auto& s = stats_[op];
+        s.calls++;
+        s.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+    size_t errors() const { return errors_; }
+
+    std::string takeOutput() {
+        std::string s = out_.str();
+        out_.str({});
+        return s;
+    }
+
+    void report(std::ostream& os) const {
+        for (const auto& [op, s] : stats_)
+            os << op << ": calls = " << s.calls << ", time = " << s.seconds * 1e3 << " ms\n";
+    }
+};
+
+template <Scalar T>
+int runBatch(const BatchOptions& opt) {
+    auto t0 = std::chrono::steady_clock::now();
+    // Собственный пул вершин: освобождается вместе с коллекцией, а не
+    // копится в глобальном пуле по умолчанию
+    auto pool = std::make_shared<VertexPool<T>>();
+    Array<std::shared_ptr<Figure<T>>> figs;
+
+    if (!opt.input.empty()) {
+        std::ifstream in(opt.input, opt.inputBinary ? std::ios::binary : std::ios::in);
+        if (!in) throw std::runtime_error("cannot open " + opt.input);
+        if (opt.inputBinary) readBinaryAll<T>(in, figs, pool);
+        else readText<T>(in, figs, pool);
+    }
+    auto tLoad = std::chrono::steady_clock::now();
+
+    std::vector<std::string> ops;
+    if (!opt.ops.empty()) {
+        std::ifstream in(opt.ops);
+        if (!in) throw std::runtime_error("cannot open " + opt.ops);
+        std::string line;
+        while (std::getline(in, line)) ops.push_back(line);
+    }
+    ops.insert(ops.end(), opt.inlineOps.begin(), opt.inlineOps.end());
+
+    std::ofstream file;
+    if (!opt.output.empty()) {
+        file.open(opt.output);
+        if (!file) throw std::runtime_error("cannot open " + opt.output);
+    }
+    std::ostream& sink = opt.output.empty() ? std::cout : file;
+
+    BatchRunner<T> runner(opt, figs, pool);
+    for (unsigned r = 0; r < opt.repeat; ++r) {
+        for (const auto& op : ops) runner.execute(op);
+        std::string chunk = runner.takeOutput();
+        sink.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+    }
+    sink.flush();
+    auto tEnd = std::chrono::steady_clock::now();
+
+    if (opt.timing) {
+        using ms = std::chrono::duration<double, std::milli>;
+        std::cerr << "figures = " << figs.size() << ", threads = " << opt.threads
+                  << ", repeat = " << opt.repeat << "\n";
+        std::cerr << "load: " << ms(tLoad - t0).count() << " ms\n";
+        runner.report(std::cerr);
+        std::cerr << "errors: " << runner.errors() << "\n";
+        std::cerr << "wall: " << ms(tEnd - t0).count() << " ms\n";
+    }
+    return runner.errors() ? 1 : 0;
+}
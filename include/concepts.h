@@ -1,7 +1,8 @@
 #pragma once
 #include <type_traits>  
 #include <concepts>
-#include <iostream>    
+#include <iostream>
+#include <cstddef>
 
 template <typename T>
 concept Scalar = std::is_arithmetic_v<T>;
@@ -20,4 +21,12 @@ concept HasCenter = requires(X a) {
 template <class X>
 concept Printable = requires(std::ostream& os, X a) {
     { os << a } -> std::same_as<std::ostream&>;
-};
\ No newline at end of file
+};
+
+template <class X>
+concept HasVertices = requires(const X& a, size_t i) {
+    { a.name() } -> std::convertible_to<const char*>;
+    { a.vertexCount() } -> std::convertible_to<size_t>;
+    { a.vertex(i) };
+    { a.area() } -> std::convertible_to<double>;
+};
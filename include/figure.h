@@ -16,6 +16,11 @@ public:
     virtual void read(std::istream& is) = 0;
     virtual std::unique_ptr<Figure<T>> clone() const = 0;
 
+    // Имя вида фигуры и доступ к вершинам (для сериализации и пакетной обработки)
+    virtual const char* name() const = 0;
+    virtual size_t vertexCount() const = 0;
+    virtual Point<T> vertex(size_t i) const = 0;
+
     operator double() const { return area(); }
 
     friend std::ostream& operator<<(std::ostream& os, const Figure<T>& f) {
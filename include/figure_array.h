@@ -1,5 +1,7 @@
 #pragma once
 #include "concepts.h"
+#include "format.h"
+#include "scene_stats.h"
 #include <memory>
 #include <iostream>
 #include <concepts>
@@ -28,14 +30,38 @@ private:
         capacity_ = newCap;
     }
 
+    // Доступ к фигуре независимо от того, хранится она по значению или по указателю
+    template <class U>
+    static const auto& deref(const U& v) {
+        if constexpr (requires { *v; }) return *v;
+        else return v;
+    }
+
+    using Elem = std::remove_cvref_t<decltype(deref(std::declval<const T&>()))>;
+
+    // --- Инкрементальные агрегаты (только для фигур) ---
+    mutable SceneStats stats_;
+
+    void track(const T& v, bool added) {
+        if constexpr (HasVertices<Elem>) {
+            if constexpr (requires { v == nullptr; })
+                if (v == nullptr) return;
+            auto s = summarize(deref(v));
+            if (added) stats_.add(s);
+            else stats_.remove(s);
+        }
+    }
+
 public:
     // --- Конструкторы ---
     Array() = default;
 
     Array(Array&& other) noexcept
-        : size_(other.size_), capacity_(other.capacity_), data_(std::move(other.data_)) {
+        : size_(other.size_), capacity_(other.capacity_), data_(std::move(other.data_)),
+          stats_(std::move(other.stats_)) {
         other.size_ = 0;
         other.capacity_ = 0;
+        other.stats_.reset();
     }
 
     Array& operator=(Array&& other) noexcept {
@@ -43,8 +69,10 @@ public:
             size_ = other.size_;
             capacity_ = other.capacity_;
             data_ = std::move(other.data_);
+            stats_ = std::move(other.stats_);
             other.size_ = 0;
             other.capacity_ = 0;
+            other.stats_.reset();
         }
         return *this;
     }
@@ -56,6 +84,8 @@ public:
     size_t size() const { return size_; }
     bool empty() const { return size_ == 0; }
 
+    // Изменения через неконстантный доступ не отслеживаются агрегатами —
+    // для этого есть set() и modify()
     T& operator[](size_t i) {
         if (i >= size_) throw std::out_of_range("bad index");
         return data_[i];
@@ -70,70 +100,159 @@ public:
     void push_back(const T& value) {
         ensure_capacity(size_ + 1);
         data_[size_++] = value;
+        track(data_[size_ - 1], true);
     }
 
     void push_back(T&& value) {
         ensure_capacity(size_ + 1);
         data_[size_++] = std::move(value);
+        track(data_[size_ - 1], true);
+    }
+
+    void set(size_t idx, T value) {
+        if (idx >= size_) throw std::out_of_range("bad index");
+        track(data_[idx], false);
+        data_[idx] = std::move(value);
+        track(data_[idx], true);
+    }
+
+    // Изменение элемента на месте: fn(T&) — агрегаты обновляются за O(1)
+    template <class Fn>
+    void modify(size_t idx, Fn fn) {
+        if (idx >= size_) throw std::out_of_range("bad index");
+        track(data_[idx], false);
+        try {
+            fn(data_[idx]);
+        } catch (...) {
+            track(data_[idx], true);
+            throw;
+        }
+        track(data_[idx], true);
     }
 
     void erase(size_t idx) {
         if (idx >= size_) throw std::out_of_range("bad index");
+        track(data_[idx], false);
         for (size_t i = idx; i + 1 < size_; ++i)
             data_[i] = std::move(data_[i + 1]);
-        size_--;
+        data_[--size_] = T{};   // освобождаем владение (удалённый последний элемент)
+    }
+
+    // Удаление всех элементов, для которых pred(элемент) истинно, за один проход
+    template <class Pred>
+    size_t eraseIf(Pred pred) {
+        size_t out = 0;
+        for (size_t i = 0; i < size_; ++i) {
+            if (pred(data_[i])) {
+                track(data_[i], false);
+                continue;
+            }
+            if (out != i) data_[out] = std::move(data_[i]);
+            ++out;
+        }
+        size_t removed = size_ - out;
+        // Хвост может хранить удалённые элементы, которые не были перезаписаны
+        for (size_t i = out; i < size_; ++i) data_[i] = T{};
+        size_ = out;
+        return removed;
     }
 
     void clear() noexcept {
         size_ = 0;
+        stats_.reset();
+    }
+
+    // --- Агрегаты: количество, площади по видам, габариты, центр масс ---
+    // Не потокобезопасно даже для константного массива: после erase/set
+    // габариты пересчитываются лениво прямо здесь (изменяется mutable stats_).
+    // При чтении из нескольких потоков вызывайте stats() под внешней
+    // блокировкой или один раз заранее, до запуска потоков.
+    const SceneStats& stats() const {
+        if constexpr (HasVertices<Elem>) {
+            if (stats_.boundsStale())
+                stats_.rebuildBounds(size_, [this](size_t i) {
+                    if constexpr (requires { data_[i] == nullptr; })
+                        if (data_[i] == nullptr) return FigureSummary{};
+                    return summarize(deref(data_[i]));
+                });
+        }
+        return stats_;
+    }
+
+    // Суммарная площадь из агрегатов за O(1): в отличие от stats(), не
+    // пересчитывает устаревшие габариты
+    double trackedArea() const { return stats_.totalArea(); }
+
+    // Полный пересчёт за O(n) — после изменений в обход set()/modify()
+    void recomputeStats() {
+        stats_.reset();
+        for (size_t i = 0; i < size_; ++i) track(data_[i], true);
     }
 
     // --- Функции печати и анализа ---
-    void printAll() const {
+    // Фигуры с доступом к вершинам форматируются через FormatBuffer (to_chars),
+    // остальные — через operator<<. threads > 1 включает параллельное форматирование.
+    void printAll(std::ostream& os = std::cout, DumpFormat fmt = DumpFormat::Text,
+                  unsigned threads = 1) const {
+        if (fmt == DumpFormat::Csv) os << "index,kind,area,vertices\n";
         if (size_ == 0) {
-            std::cout << "[Empty]\n";
+            if (fmt == DumpFormat::Text) os << "[Empty]\n";
             return;
         }
 
-        for (size_t i = 0; i < size_; ++i) {
-            const auto& v = data_[i];
+        if constexpr (HasVertices<Elem>) {
+            dumpRecords(os, size_, threads, [&](FormatBuffer& b, size_t i) {
+                formatFigure(b, i, deref(data_[i]), fmt);
+            });
+        } else {
+            for (size_t i = 0; i < size_; ++i) {
+                const auto& v = data_[i];
 
-            std::cout << i << ": ";
-            if constexpr (Printable<decltype(*v)>)
-                std::cout << *v;
-            else if constexpr (Printable<T>)
-                std::cout << v;
-            else
-                std::cout << "<no-print>";
+                os << i << ": ";
+                if constexpr (Printable<decltype(*v)>)
+                    os << *v;
+                else if constexpr (Printable<T>)
+                    os << v;
+                else
+                    os << "<no-print>";
 
-            if constexpr (HasArea<decltype(*v)>)
-                std::cout << " Area = " << double(*v);
-            else if constexpr (HasArea<T>)
-                std::cout << " Area = " << double(v);
+                if constexpr (HasArea<decltype(*v)>)
+                    os << " Area = " << double(*v);
+                else if constexpr (HasArea<T>)
+                    os << " Area = " << double(v);
 
-            std::cout << "\n";
+                os << "\n";
+            }
         }
     }
 
-    void printCenters() const {
+    void printCenters(std::ostream& os = std::cout, DumpFormat fmt = DumpFormat::Text,
+                      unsigned threads = 1) const {
+        if (fmt == DumpFormat::Csv) os << "index,x,y\n";
         if (size_ == 0) {
-            std::cout << "Empty\n";
+            if (fmt == DumpFormat::Text) os << "Empty\n";
             return;
         }
 
-        for (size_t i = 0; i < size_; ++i) {
-            const auto& v = data_[i];
-            std::cout << i << ": ";
-            if constexpr (HasCenter<decltype(*v)>) {
-                auto c = v->center();
-                std::cout << "(" << c.x << ", " << c.y << ")";
-            } else if constexpr (HasCenter<T>) {
-                auto c = v.center();
-                std::cout << "(" << c.x << ", " << c.y << ")";
-            } else {
-                std::cout << "<no center>";
+        if constexpr (HasVertices<Elem>) {
+            dumpRecords(os, size_, threads, [&](FormatBuffer& b, size_t i) {
+                formatCenter(b, i, deref(data_[i]), fmt);
+            });
+        } else {
+            for (size_t i = 0; i < size_; ++i) {
+                const auto& v = data_[i];
+                os << i << ": ";
+                if constexpr (HasCenter<decltype(*v)>) {
+                    auto c = v->center();
+                    os << "(" << c.x << ", " << c.y << ")";
+                } else if constexpr (HasCenter<T>) {
+                    auto c = v.center();
+                    os << "(" << c.x << ", " << c.y << ")";
+                } else {
+                    os << "<no center>";
+                }
+                os << "\n";
             }
-            std::cout << "\n";
         }
     }
 
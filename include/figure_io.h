@@ -0,0 +1,172 @@
+#pragma once
+#include "concepts.h"
+#include "figure.h"
+#include "rectangle.h"
+#include "rhombus.h"
+#include "trapezoid.h"
+#include "polygon.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// --- Коды видов фигур (используются в бинарном формате) ---
+enum class FigureKind : std::uint8_t {
+    Rectangle = 1,
+    Rhombus = 2,
+    Trapezoid = 3,
+    Polygon = 4,
+};
+
+inline FigureKind kindFromName(const std::string& name) {
+    if (name == "rect" || name == "Rectangle") return FigureKind::Rectangle;
+    if (name == "rhombus" || name == "Rhombus") return FigureKind::Rhombus;
+    if (name == "trapezoid" || name == "Trapezoid") return FigureKind::Trapezoid;
+    if (name == "triangle" || name == "Triangle" || name == "pentagon" || name == "Pentagon" ||
+        name == "hexagon" || name == "Hexagon" || name == "polygon" || name == "Polygon")
+        return FigureKind::Polygon;
+    throw std::invalid_argument("unknown figure kind: " + name);
+}
+
+// --- Фабрика фигур ---
+template <Scalar T>
+std::unique_ptr<Figure<T>> makeFigure(FigureKind kind, const std::shared_ptr<VertexPool<T>>& pool = defaultVertexPool<T>()) {
+    switch (kind) {
+        case FigureKind::Rectangle: return std::make_unique<Rectangle<T>>();
+        case FigureKind::Rhombus:   return std::make_unique<Rhombus<T>>();
+        case FigureKind::Trapezoid: return std::make_unique<Trapezoid<T>>();
+        case FigureKind::Polygon:   return std::make_unique<PooledPolygon<T>>(pool);
+    }
+    throw std::invalid_argument("unknown figure kind");
+}
+
+template <Scalar T>
+std::unique_ptr<Figure<T>> makeFigure(FigureKind kind, const std::array<Point<T>, 4>& p,
+                                      const std::shared_ptr<VertexPool<T>>& pool = defaultVertexPool<T>()) {
+    switch (kind) {
+        case FigureKind::Rectangle: return std::make_unique<Rectangle<T>>(p[0], p[1], p[2], p[3]);
+        case FigureKind::Rhombus:   return std::make_unique<Rhombus<T>>(p[0], p[1], p[2], p[3]);
+        case FigureKind::Trapezoid: return std::make_unique<Trapezoid<T>>(p[0], p[1], p[2], p[3]);
+        case FigureKind::Polygon:   return std::make_unique<PooledPolygon<T>>(std::vector<Point<T>>(p.begin(), p.end()), pool);
+    }
+    throw std::invalid_argument("unknown figure kind");
+}
+
+// Треугольник, пяти- и шестиугольник хранят вершины в самом объекте,
+// остальные многоугольники — в пуле вершин pool
+template <Scalar T>
+std::unique_ptr<Figure<T>> makePolygon(const Point<T>* p, size_t n, const std::shared_ptr<VertexPool<T>>& pool = defaultVertexPool<T>()) {
+    auto fixed = [p]<size_t N>() {
+        std::array<Point<T>, N> a;
+        std::copy(p, p + N, a.begin());
+        return std::make_unique<Polygon<T, N>>(a);
+    };
+    switch (n) {
+        case 3: return fixed.template operator()<3>();
+        case 5: return fixed.template operator()<5>();
+        case 6: return fixed.template operator()<6>();
+    }
+    return std::make_unique<PooledPolygon<T>>(std::vector<Point<T>>(p, p + n), pool);
+}
+
+template <Scalar T>
+std::unique_ptr<Figure<T>> makeFigure(const std::string& name, const std::shared_ptr<VertexPool<T>>& pool = defaultVertexPool<T>()) {
+    if (name == "triangle" || name == "Triangle") return std::make_unique<Triangle<T>>();
+    if (name == "pentagon" || name == "Pentagon") return std::make_unique<Pentagon<T>>();
+    if (name == "hexagon" || name == "Hexagon") return std::make_unique<Hexagon<T>>();
+    return makeFigure<T>(kindFromName(name), pool);
+}
+
+// --- Текстовый формат: одна фигура на строку ---
+// rect x1 y1 x2 y2 x3 y3 x4 y4
+// triangle|pentagon|hexagon x1 y1 ... (3, 5 или 6 вершин)
+// polygon n x1 y1 ... xn yn
+// Пустые строки и строки, начинающиеся с '#', пропускаются.
+// Вершины многоугольников без фиксированного N попадают в pool.
+template <Scalar T>
+std::unique_ptr<Figure<T>> parseFigure(const std::string& line, const std::shared_ptr<VertexPool<T>>& pool = defaultVertexPool<T>()) {
+    std::istringstream ls(line);
+    std::string kind;
+    ls >> kind;
+    auto f = makeFigure<T>(kind, pool);
+    f->read(ls);
+    if (ls.fail()) throw std::invalid_argument("bad figure line: " + line);
+    return f;
+}
+
+template <Scalar T, class Arr>
+size_t readText(std::istream& is, Arr& out, const std::shared_ptr<VertexPool<T>>& pool = defaultVertexPool<T>()) {
+    size_t n = 0;
+    std::string line;
+    while (std::getline(is, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        out.push_back(std::shared_ptr<Figure<T>>(parseFigure<T>(line, pool)));
+        ++n;
+    }
+    return n;
+}
+
+// --- Бинарный формат ---
+// Запись: uint8 вид, uint8 число вершин, затем пары double (x, y).
+// Порядок байт — родной для машины.
+template <Scalar T>
+void appendBinary(std::string& out, const Figure<T>& f) {
+    const size_t n = f.vertexCount();
+    if (n > 255) throw std::invalid_argument("too many vertices for binary format");
+    out.push_back(static_cast<char>(kindFromName(f.name())));
+    out.push_back(static_cast<char>(n));
+    for (size_t i = 0; i < n; ++i) {
+        auto p = f.vertex(i);
+        double xy[2] = { static_cast<double>(p.x), static_cast<double>(p.y) };
+        out.append(reinterpret_cast<const char*>(xy), sizeof(xy));
+    }
+}
+
+template <Scalar T>
+void writeBinary(std::ostream& os, const Figure<T>& f) {
+    std::string rec;
+    appendBinary(rec, f);
+    os.write(rec.data(), static_cast<std::streamsize>(rec.size()));
+}
+
+// Возвращает nullptr в конце потока
+template <Scalar T>
+std::unique_ptr<Figure<T>> readBinary(std::istream& is, const std::shared_ptr<VertexPool<T>>& pool = defaultVertexPool<T>()) {
+    unsigned char head[2];
+    if (!is.read(reinterpret_cast<char*>(head), sizeof(head))) {
+        // Конец потока — только если не прочитано ни байта
+        if (is.gcount() == 0) return nullptr;
+        throw std::runtime_error("truncated binary record");
+    }
+    const auto kind = static_cast<FigureKind>(head[0]);
+    const size_t n = head[1];
+    if (kind == FigureKind::Polygon ? n < 3 : n != 4)
+        throw std::runtime_error("bad binary record");
+
+    std::array<Point<T>, 255> p;
+    for (size_t i = 0; i < n; ++i) {
+        double xy[2];
+        if (!is.read(reinterpret_cast<char*>(xy), sizeof(xy)))
+            throw std::runtime_error("truncated binary record");
+        p[i] = Point<T>(static_cast<T>(xy[0]), static_cast<T>(xy[1]));
+    }
+    if (kind == FigureKind::Polygon) return makePolygon<T>(p.data(), n, pool);
+    return makeFigure<T>(kind, { p[0], p[1], p[2], p[3] }, pool);
+}
+
+template <Scalar T, class Arr>
+size_t readBinaryAll(std::istream& is, Arr& out, const std::shared_ptr<VertexPool<T>>& pool = defaultVertexPool<T>()) {
+    size_t n = 0;
+    while (auto f = readBinary<T>(is, pool)) {
+        out.push_back(std::shared_ptr<Figure<T>>(std::move(f)));
+        ++n;
+    }
+    return n;
+}
@@ -0,0 +1,228 @@
+#pragma once
+#include "concepts.h"
+#include "point.h"
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// --- Форматы вывода отчётов ---
+enum class DumpFormat {
+    Text,       // как у operator<<: "0: Rectangle: (0, 0) ... Area = 2"
+    Csv,
+    JsonLines,
+};
+
+// --- Буфер форматирования без iostream ---
+// Числа пишутся через std::to_chars прямо в буфер, который переиспользуется
+// между вызовами (clear() не освобождает память). Память под буфер не
+// инициализируется: в неё только пишут, а читают не дальше size().
+class FormatBuffer {
+private:
+    std::unique_ptr<char[]> buf_;
+    size_t cap_{0};
+    size_t len_{0};
+
+    char* grow(size_t n) {
+        if (len_ + n > cap_) reserve(std::max(cap_ * 2, len_ + n));
+        return buf_.get() + len_;
+    }
+
+public:
+    FormatBuffer() = default;
+    explicit FormatBuffer(size_t cap) { reserve(cap); }
+
+    void reserve(size_t cap) {
+        if (cap <= cap_) return;
+        std::unique_ptr<char[]> p(new char[cap]);
+        std::copy(buf_.get(), buf_.get() + len_, p.get());
+        buf_ = std::move(p);
+        cap_ = cap;
+    }
+
+    size_t capacity() const { return cap_; }
+    const char* data() const { return buf_.get(); }
+    size_t size() const { return len_; }
+    void clear() { len_ = 0; }
+
+    void append(std::string_view s) {
+        char* p = grow(s.size());
+        std::copy(s.begin(), s.end(), p);
+        len_ += s.size();
+    }
+
+    void append(char c) {
+        *grow(1) = c;
+        ++len_;
+    }
+
+    void append(size_t v) {
+        char* p = grow(24);
+        len_ = std::to_chars(p, p + 24, v).ptr - buf_.get();
+    }
+
+    // precise = false повторяет вывод ostream по умолчанию (%g, 6 знаков),
+    // precise = true даёт кратчайшую точную запись (для CSV/JSON)
+    template <Scalar T>
+    void number(T v, bool precise = false) {
+        char* p = grow(32);
+        std::to_chars_result r;
+        if constexpr (std::is_floating_point_v<T>) {
+            r = precise ? std::to_chars(p, p + 32, v)
+                        : std::to_chars(p, p + 32, v, std::chars_format::general, 6);
+        } else if constexpr (std::is_same_v<T, bool>) {
+            r = std::to_chars(p, p + 32, static_cast<int>(v));
+        } else {
+            r = std::to_chars(p, p + 32, v);
+        }
+        len_ = r.ptr - buf_.get();
+    }
+
+    void writeTo(std::ostream& os) const {
+        os.write(buf_.get(), static_cast<std::streamsize>(len_));
+    }
+};
+
+// --- Форматирование фигур и центров ---
+template <class F>
+void formatFigure(FormatBuffer& b, size_t idx, const F& f, DumpFormat fmt) {
+    const size_t n = f.vertexCount();
+    switch (fmt) {
+        case DumpFormat::Text:
+            b.append(idx);
+            b.append(": ");
+            b.append(f.name());
+            b.append(':');
+            for (size_t i = 0; i < n; ++i) {
+                auto p = f.vertex(i);
+                b.append(" (");
+                b.number(p.x);
+                b.append(", ");
+                b.number(p.y);
+                b.append(')');
+            }
+            b.append(" Area = ");
+            b.number(f.area());
+            b.append('\n');
+            break;
+        case DumpFormat::Csv:
+            b.append(idx);
+            b.append(',');
+            b.append(f.name());
+            b.append(',');
+            b.number(f.area(), true);
+            b.append(",\"");
+            for (size_t i = 0; i < n; ++i) {
+                auto p = f.vertex(i);
+                if (i) b.append(' ');
+                b.number(p.x, true);
+                b.append(' ');
+                b.number(p.y, true);
+            }
+            b.append("\"\n");
+            break;
+        case DumpFormat::JsonLines:
+            b.append("{\"index\":");
+            b.append(idx);
+            b.append(",\"kind\":\"");
+            b.append(f.name());
+            b.append("\",\"area\":");
+            b.number(f.area(), true);
+            b.append(",\"vertices\":[");
+            for (size_t i = 0; i < n; ++i) {
+                auto p = f.vertex(i);
+                if (i) b.append(',');
+                b.append('[');
+                b.number(p.x, true);
+                b.append(',');
+                b.number(p.y, true);
+                b.append(']');
+            }
+            b.append("]}\n");
+            break;
+    }
+}
+
+template <class F>
+void formatCenter(FormatBuffer& b, size_t idx, const F& f, DumpFormat fmt) {
+    auto c = f.center();
+    switch (fmt) {
+        case DumpFormat::Text:
+            b.append(idx);
+            b.append(": (");
+            b.number(c.x);
+            b.append(", ");
+            b.number(c.y);
+            b.append(")\n");
+            break;
+        case DumpFormat::Csv:
+            b.append(idx);
+            b.append(',');
+            b.number(c.x, true);
+            b.append(',');
+            b.number(c.y, true);
+            b.append('\n');
+            break;
+        case DumpFormat::JsonLines:
+            b.append("{\"index\":");
+            b.append(idx);
+            b.append(",\"x\":");
+            b.number(c.x, true);
+            b.append(",\"y\":");
+            b.number(c.y, true);
+            b.append("}\n");
+            break;
+    }
+}
+
+// --- Вывод n записей через буферы ---
+// formatOne(buf, i) дописывает запись i в буфер. При threads > 1 записи
+// форматируются блоками параллельно и выводятся строго по порядку.
+// Буферы принадлежат вызывающему потоку (thread_local) и живут между
+// вызовами, так что повторные дампы не выделяют память заново.
+template <class Fn>
+void dumpRecords(std::ostream& os, size_t n, unsigned threads, Fn formatOne) {
+    constexpr size_t kFlushBytes = 1 << 20;
+    constexpr size_t kBlock = 1 << 14;
+
+    if (threads <= 1 || n < 2 * kBlock) {
+        thread_local FormatBuffer b;
+        b.clear();
+        for (size_t i = 0; i < n; ++i) {
+            formatOne(b, i);
+            if (b.size() >= kFlushBytes) {
+                b.writeTo(os);
+                b.clear();
+            }
+        }
+        b.writeTo(os);
+        b.clear();
+        return;
+    }
+
+    // Рабочие потоки обращаются к буферам вызывающего через ссылку
+    thread_local std::vector<FormatBuffer> owned;
+    if (owned.size() < threads) owned.resize(threads);
+    auto& bufs = owned;
+    for (size_t start = 0; start < n; start += threads * kBlock) {
+        std::vector<std::thread> pool;
+        for (unsigned k = 0; k < threads; ++k) {
+            size_t b = start + k * kBlock, e = std::min(n, b + kBlock);
+            if (b >= e) break;
+            pool.emplace_back([&, k, b, e] {
+                bufs[k].clear();
+                for (size_t i = b; i < e; ++i) formatOne(bufs[k], i);
+            });
+        }
+        for (size_t k = 0; k < pool.size(); ++k) {
+            pool[k].join();
+            bufs[k].writeTo(os);
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "concepts.h"
+#include "point.h"
+#include <cmath>
+#include <cstddef>
+
+// --- Общие геометрические ядра для всех фигур ---
+// Работают с непрерывным массивом вершин, все вычисления — в double.
+
+template <Scalar T>
+inline double pointDist(const Point<T>& u, const Point<T>& v) {
+    double dx = double(u.x) - double(v.x), dy = double(u.y) - double(v.y);
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// Ориентированная площадь по формуле шнурков (> 0 при обходе против часовой)
+template <Scalar T>
+inline double signedArea(const Point<T>* p, size_t n) {
+    double s = 0.0;
+    for (size_t i = 0, j = n - 1; i < n; j = i++)
+        s += double(p[j].x) * double(p[i].y) - double(p[i].x) * double(p[j].y);
+    return s / 2.0;
+}
+
+template <Scalar T>
+inline double shoelaceArea(const Point<T>* p, size_t n) {
+    return std::abs(signedArea(p, n));
+}
+
+// Среднее вершин — так считается center() у всех фигур. Сумма копится в
+// double (в T она переполняется уже для short), в T приводится только результат.
+template <Scalar T>
+inline Point<T> vertexCenter(const Point<T>* p, size_t n) {
+    double sx = 0.0, sy = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        sx += double(p[i].x);
+        sy += double(p[i].y);
+    }
+    return { static_cast<T>(sx / double(n)), static_cast<T>(sy / double(n)) };
+}
+
+// Центр масс многоугольника (для невырожденной площади)
+template <Scalar T>
+inline Point<double> areaCentroid(const Point<T>* p, size_t n) {
+    double cx = 0.0, cy = 0.0, a = 0.0;
+    for (size_t i = 0, j = n - 1; i < n; j = i++) {
+        double cr = double(p[j].x) * double(p[i].y) - double(p[i].x) * double(p[j].y);
+        a += cr;
+        cx += (double(p[j].x) + double(p[i].x)) * cr;
+        cy += (double(p[j].y) + double(p[i].y)) * cr;
+    }
+    return { cx / (3.0 * a), cy / (3.0 * a) };
+}
+
+// Выпуклый простой многоугольник: все повороты одного знака и полный
+// оборот ровно 2π (отсекает самопересекающиеся «звёзды»). eps — допуск
+// на синус угла поворота, не зависит от масштаба фигуры.
+template <Scalar T>
+inline bool isConvexPolygon(const Point<T>* p, size_t n, double eps = 1e-9) {
+    if (n < 3) return false;
+    int sign = 0;
+    double turn = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        const auto& a = p[i];
+        const auto& b = p[(i + 1) % n];
+        const auto& c = p[(i + 2) % n];
+        double ux = double(b.x) - double(a.x), uy = double(b.y) - double(a.y);
+        double vx = double(c.x) - double(b.x), vy = double(c.y) - double(b.y);
+        double cr = ux * vy - uy * vx;
+        // Допуск относительный: векторное произведение растёт как квадрат размера
+        if (std::abs(cr) <= eps * std::hypot(ux, uy) * std::hypot(vx, vy)) return false;
+        int s = cr > 0 ? 1 : -1;
+        if (sign == 0) sign = s;
+        else if (s != sign) return false;
+        turn += std::atan2(cr, ux * vx + uy * vy);
+    }
+    return std::abs(std::abs(turn) - 2.0 * M_PI) < 1e-6;
+}
@@ -0,0 +1,338 @@
+#pragma once
+#include "concepts.h"
+#include "figure.h"
+#include "figure_array.h"
+#include "figure_io.h"
+#include "scene_stats.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// Тип хранения координат: float или квантованное целое
+template <class C>
+concept PackedCoord = std::is_same_v<C, float> || std::is_same_v<C, std::int16_t> ||
+                      std::is_same_v<C, std::int32_t>;
+
+// --- Компактное хранилище фигур со смешанной точностью ---
+//
+// Координаты лежат подряд в одном массиве (x, y, x, y, ...) относительно
+// одного из начал отсчёта своего блока (chunk). Для float хранится само
+// смещение, для целых — смещение в единицах quantum. Площади и центры всегда
+// считаются в double, каждая операция возвращает оценку сверху для
+// абсолютной погрешности относительно исходных координат.
+//
+// Блок — до kChunkFigures подряд идущих фигур. Для целых у блока до
+// kMaxOrigins начал на сетке с шагом G = quantum * max(C) (когда они
+// кончаются, начинается новый блок). Фигура хранит номер начала (1 байт) и
+// кодируется относительно узла, ближайшего к её центру, поэтому фигуры
+// размером до G помещаются в диапазон типа при любом порядке добавления.
+// Фигура крупнее G получает собственное начало в своём центре. Для float
+// начало у блока одно — центр его первой фигуры.
+//
+// Для оценки погрешности totalArea() блок при добавлении копит наибольший
+// модуль координат, сумму периметров и модулей слагаемых формулы шнурков,
+// поэтому сама сумма площадей идёт без лишней работы.
+template <PackedCoord C>
+class PackedScene {
+public:
+    struct Estimate {
+        double value{0.0};
+        double error{0.0};
+    };
+
+    struct CenterEstimate {
+        Point<double> value;
+        double error{0.0};     // по каждой координате
+    };
+
+    static constexpr size_t kChunkFigures = 4096;
+    static constexpr size_t kMaxOrigins = 256;
+    static constexpr bool kQuantized = std::is_integral_v<C>;
+
+private:
+    struct Chunk {
+        size_t first;              // индекс первой фигуры блока
+        size_t firstOrigin;        // начала блока — origins_[firstOrigin ...]
+        double maxMag{0.0};        // наибольший модуль хранимой координаты
+        double perimeter{0.0};     // сумма (|dx| + |dy|) по рёбрам всех фигур
+        double shoelaceMag{0.0};   // сумма n * (модули слагаемых шнурков)
+        size_t vertices{0};
+    };
+
+    double quantum_;
+    std::vector<C> xy_;
+    std::vector<std::uint32_t> offset_{0};   // начало вершин фигуры i в xy_ (в парах), не более 2^32 - 1
+    std::vector<std::uint8_t> kind_;
+    std::vector<std::uint8_t> origin_;       // номер начала фигуры i в её блоке
+    std::vector<Point<double>> origins_;
+    std::vector<Chunk> chunks_;
+
+    const Chunk& chunkOf(size_t i) const {
+        auto it = std::upper_bound(chunks_.begin(), chunks_.end(), i,
+                                   [](size_t v, const Chunk& c) { return v < c.first; });
+        return *(it - 1);
+    }
+
+    const Point<double>& originOf(size_t i) const {
+        return origins_[chunkOf(i).firstOrigin + origin_[i]];
+    }
+
+    bool fits(double v) const {
+        if constexpr (kQuantized) {
+            double q = std::nearbyint(v / quantum_);
+            return q >= double(std::numeric_limits<C>::min()) && q <= double(std::numeric_limits<C>::max());
+        } else {
+            return true;
+        }
+    }
+
+    C encode(double v) const {
+        if constexpr (kQuantized) return static_cast<C>(std::nearbyint(v / quantum_));
+        else return static_cast<C>(v);
+    }
+
+    // Погрешность хранения одной координаты (в единицах хранения);
+    // m — наибольший модуль хранимых координат фигуры
+    static double coordError(double m) {
+        if constexpr (kQuantized) return 0.5 + 4.0 * DBL_EPSILON * m;   // округление до шага
+        else return m * std::ldexp(1.0, -23);                          // половина ulp float с запасом
+    }
+
+    struct Terms {
+        double mag{0.0}, per{0.0}, m{0.0};
+    };
+
+    // Слагаемые оценки погрешности для n вершин p (в единицах хранения)
+    static Terms errorTerms(const C* p, size_t n) {
+        Terms t;
+        for (size_t k = 0, j = n - 1; k < n; j = k++) {
+            double x = p[2 * k], y = p[2 * k + 1];
+            double xj = p[2 * j], yj = p[2 * j + 1];
+            t.mag += std::abs(xj * y) + std::abs(x * yj);
+            t.per += std::abs(x - xj) + std::abs(y - yj);
+            t.m = std::max(t.m, std::max(std::abs(x), std::abs(y)));
+        }
+        return t;
+    }
+
+    // Удвоенная площадь в единицах хранения (без знака)
+    static double twiceArea(const C* p, size_t n) {
+        double s = 0.0;
+        for (size_t k = 0, j = n - 1; k < n; j = k++)
+            s += double(p[2 * j]) * double(p[2 * k + 1]) - double(p[2 * k]) * double(p[2 * j + 1]);
+        return std::abs(s);
+    }
+
+    // Сдвиг каждой координаты на d меняет площадь не больше чем на
+    // d * (сумма |dx| + |dy| по рёбрам) + n * d^2; к этому добавляется ошибка
+    // округления формулы шнурков в double (n * eps * сумма модулей слагаемых)
+    static double areaError(double d, double per, double n, double nMag) {
+        return d * per + n * d * d + DBL_EPSILON * nMag;
+    }
+
+    // Площадь фигуры i в единицах хранения и её погрешность
+    Estimate rawArea(size_t i) const {
+        const size_t n = offset_[i + 1] - offset_[i];
+        const C* p = xy_.data() + 2 * offset_[i];
+        const Terms t = errorTerms(p, n);
+        return { twiceArea(p, n) / 2.0, areaError(coordError(t.m), t.per, double(n), double(n) * t.mag) };
+    }
+
+    template <Scalar T>
+    bool fitsOrigin(const Figure<T>& f, size_t n, const Point<double>& o) const {
+        for (size_t k = 0; k < n; ++k) {
+            auto v = f.vertex(k);
+            if (!fits(double(v.x) - o.x) || !fits(double(v.y) - o.y)) return false;
+        }
+        return true;
+    }
+
+    // Начало отсчёта o для фигуры в текущем блоке (или в новом при newChunk).
+    // Возвращает номер начала в блоке; номер, равный числу начал блока,
+    // означает, что o нужно добавить.
+    template <Scalar T>
+    size_t chooseOrigin(const Figure<T>& f, size_t n, bool newChunk, Point<double>& o) const {
+        const size_t base = newChunk ? origins_.size() : chunks_.back().firstOrigin;
+        const size_t count = origins_.size() - base;
+        if constexpr (!kQuantized) {
+            if (count > 0) {
+                o = origins_[base];
+                return 0;
+            }
+        }
+
+        double x0 = INFINITY, y0 = INFINITY, x1 = -INFINITY, y1 = -INFINITY;
+        for (size_t k = 0; k < n; ++k) {
+            auto v = f.vertex(k);
+            x0 = std::min(x0, double(v.x)); x1 = std::max(x1, double(v.x));
+            y0 = std::min(y0, double(v.y)); y1 = std::max(y1, double(v.y));
+        }
+        o = { (x0 + x1) / 2.0, (y0 + y1) / 2.0 };
+        if constexpr (kQuantized) {
+            const double g = quantum_ * double(std::numeric_limits<C>::max());
+            const Point<double> node{ std::nearbyint(o.x / g) * g, std::nearbyint(o.y / g) * g };
+            if (fitsOrigin(f, n, node)) {
+                o = node;
+                for (size_t k = 0; k < count; ++k)
+                    if (origins_[base + k].x == node.x && origins_[base + k].y == node.y) return k;
+            } else if (!fitsOrigin(f, n, o)) {
+                throw std::out_of_range("figure does not fit the quantization range");
+            }
+        }
+        return count;
+    }
+
+public:
+    // quantum — шаг квантования для целочисленного хранения (для float не используется)
+    explicit PackedScene(double quantum = 1e-3) : quantum_(kQuantized ? quantum : 1.0) {
+        if (!(quantum > 0.0)) throw std::invalid_argument("quantum must be positive");
+    }
+
+    template <Scalar T>
+    void push_back(const Figure<T>& f) {
+        const size_t n = f.vertexCount();
+        const size_t idx = size();
+        // Смещения 32-битные (экономия памяти): проверяем до любых изменений
+        if (n > std::numeric_limits<std::uint32_t>::max() - offset_.back())
+            throw std::out_of_range("too many vertices for 32-bit offsets");
+        const auto kind = static_cast<std::uint8_t>(kindFromName(f.name()));
+
+        bool newChunk = chunks_.empty() || idx - chunks_.back().first >= kChunkFigures;
+        Point<double> o;
+        size_t k = chooseOrigin(f, n, newChunk, o);
+        if (!newChunk && k == kMaxOrigins) {
+            newChunk = true;
+            k = chooseOrigin(f, n, newChunk, o);
+        }
+
+        if (newChunk) chunks_.push_back({ idx, origins_.size() });
+        auto& c = chunks_.back();
+        if (k == origins_.size() - c.firstOrigin) origins_.push_back(o);
+        for (size_t v = 0; v < n; ++v) {
+            auto p = f.vertex(v);
+            xy_.push_back(encode(double(p.x) - o.x));
+            xy_.push_back(encode(double(p.y) - o.y));
+        }
+        const Terms t = errorTerms(xy_.data() + 2 * offset_.back(), n);
+        c.maxMag = std::max(c.maxMag, t.m);
+        c.perimeter += t.per;
+        c.shoelaceMag += double(n) * t.mag;
+        c.vertices += n;
+        offset_.push_back(static_cast<std::uint32_t>(offset_.back() + n));
+        kind_.push_back(kind);
+        origin_.push_back(static_cast<std::uint8_t>(k));
+    }
+
+    template <Scalar T>
+    static PackedScene from(const Array<std::shared_ptr<Figure<T>>>& arr, double quantum = 1e-3) {
+        PackedScene s(quantum);
+        s.reserve(arr.size(), 4 * arr.size());
+        for (size_t i = 0; i < arr.size(); ++i) s.push_back(*arr[i]);
+        return s;
+    }
+
+    void reserve(size_t figures, size_t vertices) {
+        xy_.reserve(2 * vertices);
+        offset_.reserve(figures + 1);
+        kind_.reserve(figures);
+        origin_.reserve(figures);
+    }
+
+    size_t size() const { return kind_.size(); }
+    bool empty() const { return kind_.empty(); }
+    double quantum() const { return quantum_; }
+
+    // Байты, занятые данными (по ёмкости векторов)
+    size_t memoryBytes() const {
+        return xy_.capacity() * sizeof(C) + offset_.capacity() * sizeof(std::uint32_t) +
+               kind_.capacity() + origin_.capacity() + origins_.capacity() * sizeof(Point<double>) +
+               chunks_.capacity() * sizeof(Chunk);
+    }
+
+    Estimate area(size_t i) const {
+        if (i >= size()) throw std::out_of_range("bad index");
+        auto r = rawArea(i);
+        const double q2 = quantum_ * quantum_;
+        return { r.value * q2, r.error * q2 };
+    }
+
+    CenterEstimate center(size_t i) const {
+        if (i >= size()) throw std::out_of_range("bad index");
+        const auto& o = originOf(i);
+        const size_t n = offset_[i + 1] - offset_[i];
+        const C* p = xy_.data() + 2 * offset_[i];
+
+        double sx = 0.0, sy = 0.0, m = 0.0;
+        for (size_t k = 0; k < n; ++k) {
+            sx += p[2 * k];
+            sy += p[2 * k + 1];
+            m = std::max(m, std::max(std::abs(double(p[2 * k])), std::abs(double(p[2 * k + 1]))));
+        }
+        double mx = sx / double(n), my = sy / double(n);
+        Point<double> v{ o.x + mx * quantum_, o.y + my * quantum_ };
+        double err = coordError(m) * quantum_ +
+                     DBL_EPSILON * (std::abs(o.x) + std::abs(o.y) + (std::abs(mx) + std::abs(my)) * quantum_);
+        return { v, err };
+    }
+
+    // Внутри блока суммы обычные, между блоками — с компенсацией. Погрешность
+    // берётся из накопленных при добавлении величин блока, за O(числа блоков):
+    // наибольший модуль координат блока оценивает сверху каждую его фигуру.
+    Estimate totalArea() const {
+        CompensatedSum s, e;
+        const C* xy = xy_.data();
+        const std::uint32_t* off = offset_.data();
+        for (size_t c = 0; c < chunks_.size(); ++c) {
+            const auto& ch = chunks_[c];
+            size_t end = c + 1 < chunks_.size() ? chunks_[c + 1].first : size();
+            double cs = 0.0;
+            for (size_t i = ch.first; i < end; ++i)
+                cs += twiceArea(xy + 2 * size_t(off[i]), off[i + 1] - off[i]);
+            s.add(cs / 2.0);
+            e.add(areaError(coordError(ch.maxMag), ch.perimeter, double(ch.vertices), ch.shoelaceMag));
+        }
+        const double q2 = quantum_ * quantum_;
+        double sum = s.value() * q2;
+        return { sum, e.value() * q2 + double(kChunkFigures) * DBL_EPSILON * std::abs(sum) };
+    }
+
+    // Восстановление фигуры в double. Если после квантования фигура не проходит
+    // проверку своего вида (например, стороны ромба разошлись больше допуска),
+    // возвращается выпуклый многоугольник с теми же вершинами. Вершины
+    // многоугольников кладутся в pool; по умолчанию — в собственный пул
+    // фигуры, который освобождается вместе с ней.
+    std::unique_ptr<Figure<double>> unpack(size_t i, std::shared_ptr<VertexPool<double>> pool = nullptr) const {
+        if (i >= size()) throw std::out_of_range("bad index");
+        const auto& o = originOf(i);
+        const size_t n = offset_[i + 1] - offset_[i];
+        const C* p = xy_.data() + 2 * offset_[i];
+
+        std::vector<Point<double>> v(n);
+        for (size_t k = 0; k < n; ++k)
+            v[k] = { o.x + double(p[2 * k]) * quantum_, o.y + double(p[2 * k + 1]) * quantum_ };
+
+        const auto kind = static_cast<FigureKind>(kind_[i]);
+        if (kind != FigureKind::Polygon && n == 4) {
+            try {
+                return makeFigure<double>(kind, { v[0], v[1], v[2], v[3] }, pool);
+            } catch (const std::logic_error&) {
+            }
+        }
+        if (!pool) pool = std::make_shared<VertexPool<double>>();
+        return makePolygon<double>(v.data(), n, pool);
+    }
+
+    // Все многоугольники результата делят один пул (по умолчанию — новый)
+    Array<std::shared_ptr<Figure<double>>> toArray(std::shared_ptr<VertexPool<double>> pool = nullptr) const {
+        if (!pool) pool = std::make_shared<VertexPool<double>>();
+        Array<std::shared_ptr<Figure<double>>> arr;
+        for (size_t i = 0; i < size(); ++i) arr.push_back(std::shared_ptr<Figure<double>>(unpack(i, pool)));
+        return arr;
+    }
+};
@@ -13,8 +13,8 @@ struct Point {
     Point() = default;
     Point(T _x, T _y) : x(_x), y(_y) {}
 
-    Point<T> operator+(const Point<T>& o) const { return { x + o.x, y + o.y }; }
-    Point<T> operator-(const Point<T>& o) const { return { x - o.x, y - o.y }; }
+    Point<T> operator+(const Point<T>& o) const { return { static_cast<T>(x + o.x), static_cast<T>(y + o.y) }; }
+    Point<T> operator-(const Point<T>& o) const { return { static_cast<T>(x - o.x), static_cast<T>(y - o.y) }; }
     Point<T> operator/(double d) const { return { static_cast<T>(x / d), static_cast<T>(y / d) }; }
 
     bool operator==(const Point<T>& o) const {
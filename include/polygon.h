@@ -0,0 +1,214 @@
+#pragma once
+#include "concepts.h"
+#include "figure.h"
+#include "geometry.h"
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+inline const char* polygonName(size_t n) {
+    switch (n) {
+        case 3: return "Triangle";
+        case 5: return "Pentagon";
+        case 6: return "Hexagon";
+    }
+    return "Polygon";
+}
+
+// --- Выпуклый многоугольник с N вершинами (N известно при компиляции) ---
+// Вершины хранятся внутри объекта, без отдельных выделений памяти.
+template <Scalar T, size_t N>
+class Polygon : public Figure<T> {
+    static_assert(N >= 3, "polygon needs at least 3 vertices");
+
+private:
+    std::array<Point<T>, N> pts_{};
+
+    void validate() const {
+        if (!isConvexPolygon(pts_.data(), N))
+            throw std::logic_error("Not a convex polygon");
+    }
+
+public:
+    Polygon() = default;
+
+    explicit Polygon(const std::array<Point<T>, N>& pts) : pts_(pts) {
+        validate();
+    }
+
+    void read(std::istream& is) override {
+        for (auto& p : pts_) is >> p.x >> p.y;
+        validate();
+    }
+
+    void print(std::ostream& os) const override {
+        os << name() << ":";
+        for (const auto& p : pts_) os << " " << p;
+    }
+
+    Point<T> center() const override {
+        return vertexCenter(pts_.data(), N);
+    }
+
+    double area() const override {
+        return shoelaceArea(pts_.data(), N);
+    }
+
+    const char* name() const override { return polygonName(N); }
+
+    size_t vertexCount() const override { return N; }
+
+    Point<T> vertex(size_t i) const override {
+        if (i >= N) throw std::out_of_range("bad vertex index");
+        return pts_[i];
+    }
+
+    bool operator==(const Polygon& other) const {
+        return pts_ == other.pts_;
+    }
+
+    std::unique_ptr<Figure<T>> clone() const override {
+        return std::make_unique<Polygon<T, N>>(*this);
+    }
+};
+
+template <Scalar T>
+using Triangle = Polygon<T, 3>;
+
+template <Scalar T>
+using Pentagon = Polygon<T, 5>;
+
+template <Scalar T>
+using Hexagon = Polygon<T, 6>;
+
+// --- Общий пул вершин для многоугольников с числом вершин во время выполнения ---
+// Вершины фигур лежат подряд в одном векторе; фигура хранит смещение и длину.
+// Диапазоны не переиспользуются после удаления фигур: пул только растёт.
+// Фигуры держат пул через shared_ptr, поэтому он живёт, пока жива хоть одна
+// из них. Долгоживущий код (пакетный режим, сервисы) заводит собственный пул
+// и освобождает его вместе с коллекцией либо вызывает clear(), когда фигур
+// из пула не осталось. Пул не потокобезопасен на запись.
+template <Scalar T>
+class VertexPool {
+private:
+    std::vector<Point<T>> pts_;
+
+public:
+    size_t append(const Point<T>* p, size_t n) {
+        size_t off = pts_.size();
+        pts_.insert(pts_.end(), p, p + n);
+        return off;
+    }
+
+    const Point<T>* data(size_t off) const { return pts_.data() + off; }
+    size_t size() const { return pts_.size(); }
+    void reserve(size_t n) { pts_.reserve(n); }
+
+    // Только если ни одна фигура больше не ссылается на пул
+    // (use_count() == 1 у владельца shared_ptr)
+    void clear() {
+        pts_.clear();
+        pts_.shrink_to_fit();
+    }
+};
+
+// Пул по умолчанию: живёт до конца программы и никогда не очищается
+template <Scalar T>
+std::shared_ptr<VertexPool<T>> defaultVertexPool() {
+    static auto pool = std::make_shared<VertexPool<T>>();
+    return pool;
+}
+
+// Копии (и clone()) разделяют диапазон вершин в пуле; read() добавляет новый
+// диапазон, поэтому копии не видят изменений друг друга.
+template <Scalar T>
+class PooledPolygon : public Figure<T> {
+private:
+    std::shared_ptr<VertexPool<T>> pool_;
+    size_t offset_{0};
+    size_t count_{0};
+
+    const Point<T>* pts() const { return pool_->data(offset_); }
+
+    void assign(const Point<T>* p, size_t n) {
+        if (!isConvexPolygon(p, n))
+            throw std::logic_error("Not a convex polygon");
+        offset_ = pool_->append(p, n);
+        count_ = n;
+    }
+
+public:
+    explicit PooledPolygon(std::shared_ptr<VertexPool<T>> pool = defaultVertexPool<T>())
+        : pool_(std::move(pool)) {}
+
+    PooledPolygon(const std::vector<Point<T>>& pts,
+                  std::shared_ptr<VertexPool<T>> pool = defaultVertexPool<T>())
+        : pool_(std::move(pool)) {
+        assign(pts.data(), pts.size());
+    }
+
+    static constexpr size_t kMaxVertices = 255;
+
+    // Формат: n x1 y1 ... xn yn, 3 <= n <= kMaxVertices; иначе поток
+    // переводится в состояние ошибки до выделения памяти
+    void read(std::istream& is) override {
+        size_t n = 0;
+        is >> n;
+        if (!is || n < 3 || n > kMaxVertices) {
+            is.setstate(std::ios::failbit);
+            return;
+        }
+        std::vector<Point<T>> tmp(n);
+        for (auto& p : tmp) is >> p.x >> p.y;
+        if (!is) return;
+        assign(tmp.data(), n);
+    }
+
+    void print(std::ostream& os) const override {
+        os << name() << ":";
+        for (size_t i = 0; i < count_; ++i) os << " " << pts()[i];
+    }
+
+    Point<T> center() const override {
+        return vertexCenter(pts(), count_);
+    }
+
+    double area() const override {
+        return shoelaceArea(pts(), count_);
+    }
+
+    const char* name() const override { return polygonName(count_); }
+
+    size_t vertexCount() const override { return count_; }
+
+    Point<T> vertex(size_t i) const override {
+        if (i >= count_) throw std::out_of_range("bad vertex index");
+        return pts()[i];
+    }
+
+    bool operator==(const PooledPolygon& other) const {
+        if (count_ != other.count_) return false;
+        for (size_t i = 0; i < count_; ++i)
+            if (!(pts()[i] == other.pts()[i])) return false;
+        return true;
+    }
+
+    std::unique_ptr<Figure<T>> clone() const override {
+        return std::make_unique<PooledPolygon<T>>(*this);
+    }
+};
+
+template <Scalar T, size_t N>
+inline std::istream& operator>>(std::istream& is, Polygon<T, N>& p) {
+    p.read(is);
+    return is;
+}
+
+template <Scalar T>
+inline std::istream& operator>>(std::istream& is, PooledPolygon<T>& p) {
+    p.read(is);
+    return is;
+}
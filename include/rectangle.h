@@ -1,18 +1,19 @@
 #pragma once
 #include "concepts.h"
 #include "figure.h"
+#include "geometry.h"
+#include <array>
 #include <memory>
 #include <cmath>
+#include <stdexcept>
 
 template <Scalar T>
 class Rectangle : public Figure<T> {
 private:
     std::unique_ptr<Point<T>> a, b, c, d;
 
-    static double tri_area(const Point<T>& p1, const Point<T>& p2, const Point<T>& p3) {
-        return std::abs((p1.x*(p2.y - p3.y) +
-                         p2.x*(p3.y - p1.y) +
-                         p3.x*(p1.y - p2.y)) / 2.0);
+    std::array<Point<T>, 4> points() const {
+        return { *a, *b, *c, *d };
     }
 
 public:
@@ -57,17 +58,33 @@ public:
     }
 
     Point<T> center() const override {
-        return (*a + *b + *c + *d) / 4.0;
+        auto p = points();
+        return vertexCenter(p.data(), p.size());
     }
 
     double area() const override {
-        return tri_area(*a, *b, *c) + tri_area(*a, *c, *d);
+        auto p = points();
+        return shoelaceArea(p.data(), p.size());
     }
 
     bool operator==(const Rectangle& other) const {
         return *a == *other.a && *b == *other.b && *c == *other.c && *d == *other.d;
     }
 
+    const char* name() const override { return "Rectangle"; }
+
+    size_t vertexCount() const override { return 4; }
+
+    Point<T> vertex(size_t i) const override {
+        switch (i) {
+            case 0: return *a;
+            case 1: return *b;
+            case 2: return *c;
+            case 3: return *d;
+        }
+        throw std::out_of_range("bad vertex index");
+    }
+
     std::unique_ptr<Figure<T>> clone() const override {
         return std::make_unique<Rectangle<T>>(*this);
     }
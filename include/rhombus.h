@@ -1,6 +1,8 @@
 #pragma once
 #include "concepts.h"
 #include "figure.h"
+#include "geometry.h"
+#include <array>
 #include <memory>
 #include <cmath>
 #include <stdexcept>
@@ -10,12 +12,8 @@ class Rhombus : public Figure<T> {
 private:
     std::unique_ptr<Point<T>> p1, p2, p3, p4;
 
-    static double tri_area(const Point<T>& a, const Point<T>& b, const Point<T>& c) {
-        return std::abs((a.x*(b.y - c.y) + b.x*(c.y - a.y) + c.x*(a.y - b.y)) / 2.0);
-    }
-
-    static double dist(const Point<T>& u, const Point<T>& v) {
-        return std::sqrt((u.x - v.x) * (u.x - v.x) + (u.y - v.y) * (u.y - v.y));
+    std::array<Point<T>, 4> points() const {
+        return { *p1, *p2, *p3, *p4 };
     }
 
     static double angle(const Point<T>& a, const Point<T>& b, const Point<T>& c) {
@@ -35,16 +33,20 @@ private:
 
     void validate() const {
         // Проверка равенства всех сторон
-        double s1 = dist(*p1, *p2);
-        double s2 = dist(*p2, *p3);
-        double s3 = dist(*p3, *p4);
-        double s4 = dist(*p4, *p1);
+        double s1 = pointDist(*p1, *p2);
+        double s2 = pointDist(*p2, *p3);
+        double s3 = pointDist(*p3, *p4);
+        double s4 = pointDist(*p4, *p1);
 
         if (!(std::abs(s1 - s2) < 1e-6 &&
               std::abs(s2 - s3) < 1e-6 &&
               std::abs(s3 - s4) < 1e-6))
             throw std::logic_error("Not a rhombus (sides differ)");
 
+        auto p = points();
+        if (!isConvexPolygon(p.data(), p.size()))
+            throw std::logic_error("Not a rhombus (not convex)");
+
         // Проверка цикличности (ромб должен быть квадратом)
         if (!isCyclic())
             throw std::logic_error("Rhombus must be cyclic — only squares are cyclic");
@@ -91,12 +93,27 @@ public:
     }
 
     Point<T> center() const override {
-        Point<T> sum = *p1 + *p2 + *p3 + *p4;
-        return sum / 4.0;
+        auto p = points();
+        return vertexCenter(p.data(), p.size());
     }
 
     double area() const override {
-        return tri_area(*p1, *p2, *p3) + tri_area(*p1, *p3, *p4);
+        auto p = points();
+        return shoelaceArea(p.data(), p.size());
+    }
+
+    const char* name() const override { return "Rhombus"; }
+
+    size_t vertexCount() const override { return 4; }
+
+    Point<T> vertex(size_t i) const override {
+        switch (i) {
+            case 0: return *p1;
+            case 1: return *p2;
+            case 2: return *p3;
+            case 3: return *p4;
+        }
+        throw std::out_of_range("bad vertex index");
     }
 
     std::unique_ptr<Figure<T>> clone() const override {
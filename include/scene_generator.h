@@ -0,0 +1,225 @@
+#pragma once
+#include "concepts.h"
+#include "figure.h"
+#include "figure_array.h"
+#include "rectangle.h"
+#include "rhombus.h"
+#include "trapezoid.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// --- Генератор случайных сцен ---
+//
+// Все вершины строятся на целочисленной решётке (повёрнутые векторы (a, b) и
+// (-b, a)), поэтому прямоугольники, квадраты (Rhombus) и равнобедренные
+// трапеции проходят проверки точно для любого Scalar — и целого, и
+// вещественного. Для вещественных T координаты умножаются на scale
+// (степень двойки сохраняет точность).
+//
+// Последовательность фигур полностью определяется seed: используется только
+// выход std::mt19937_64 (он стандартизован), без стандартных распределений.
+
+enum class Placement {
+    Uniform,      // центры равномерно в квадрате [-extent, extent]^2
+    Clustered,    // центры вокруг clusters случайных точек (нормально)
+};
+
+struct SceneOptions {
+    std::uint64_t seed{1};
+    Placement placement{Placement::Uniform};
+    long extent{1000};
+    size_t clusters{8};
+    double clusterSpread{50.0};
+    long minSize{1};              // компоненты образующего вектора: max(|a|, |b|) в [minSize, maxSize]
+    long maxSize{16};
+    double degenerate{0.0};       // доля почти вырожденных фигур (тонкие, сильно вытянутые)
+    double rectangleWeight{1.0};
+    double rhombusWeight{1.0};
+    double trapezoidWeight{1.0};
+    double scale{1.0};            // только для вещественных T
+};
+
+// Фигура и её точные характеристики, посчитанные генератором в double
+template <Scalar T>
+struct GeneratedFigure {
+    std::shared_ptr<Figure<T>> figure;
+    double area{0.0};
+    Point<double> center;
+};
+
+template <Scalar T>
+class SceneGenerator {
+    // Вершины строятся вокруг центров в [-extent, extent], поэтому нужны
+    // знаковые координаты (bool и беззнаковые типы исключены)
+    static_assert(std::is_signed_v<T> && (std::is_floating_point_v<T> || sizeof(T) >= 2),
+                  "coordinate type must be signed and at least 16 bits wide");
+
+private:
+    // Наибольшее удаление вершины от центра фигуры в единицах maxSize
+    static constexpr long kMaxReach = 65;
+
+    struct Lattice {
+        long x, y;
+    };
+
+    SceneOptions opt_;
+    std::mt19937_64 rng_;
+    std::vector<Lattice> clusterCenters_;
+    double scale_;
+
+    double uniform01() {
+        return double(rng_() >> 11) * 0x1.0p-53;
+    }
+
+    // Равномерно в [lo, hi] без смещения (отбраковка)
+    long uniformInt(long lo, long hi) {
+        const std::uint64_t span = std::uint64_t(hi - lo) + 1;
+        const std::uint64_t limit = UINT64_MAX - UINT64_MAX % span;
+        std::uint64_t r;
+        do { r = rng_(); } while (r >= limit);
+        return lo + long(r % span);
+    }
+
+    double normal() {
+        double u1 = uniform01(), u2 = uniform01();
+        return std::sqrt(-2.0 * std::log(1.0 - u1)) * std::cos(2.0 * M_PI * u2);
+    }
+
+    Lattice randomVector(long lo, long hi) {
+        while (true) {
+            long a = uniformInt(-hi, hi), b = uniformInt(-hi, hi);
+            if (std::max(std::abs(a), std::abs(b)) >= lo) return { a, b };
+        }
+    }
+
+    Lattice randomCenter() {
+        if (opt_.placement == Placement::Clustered && !clusterCenters_.empty()) {
+            const auto& c = clusterCenters_[uniformInt(0, long(clusterCenters_.size()) - 1)];
+            long x = c.x + std::lround(normal() * opt_.clusterSpread);
+            long y = c.y + std::lround(normal() * opt_.clusterSpread);
+            return { std::clamp(x, -opt_.extent, opt_.extent), std::clamp(y, -opt_.extent, opt_.extent) };
+        }
+        return { uniformInt(-opt_.extent, opt_.extent), uniformInt(-opt_.extent, opt_.extent) };
+    }
+
+    Point<T> toPoint(long x, long y) const {
+        return { static_cast<T>(double(x) * scale_), static_cast<T>(double(y) * scale_) };
+    }
+
+    template <class F>
+    GeneratedFigure<T> finish(const Lattice (&v)[4]) {
+        GeneratedFigure<T> g;
+        g.figure = std::make_shared<F>(toPoint(v[0].x, v[0].y), toPoint(v[1].x, v[1].y),
+                                       toPoint(v[2].x, v[2].y), toPoint(v[3].x, v[3].y));
+        double s = 0.0, cx = 0.0, cy = 0.0;
+        for (size_t i = 0, j = 3; i < 4; j = i++) {
+            s += double(v[j].x) * double(v[i].y) - double(v[i].x) * double(v[j].y);
+            cx += double(v[i].x);
+            cy += double(v[i].y);
+        }
+        g.area = std::abs(s) / 2.0 * scale_ * scale_;
+        g.center = { cx / 4.0 * scale_, cy / 4.0 * scale_ };
+        return g;
+    }
+
+    bool degenerate() {
+        return opt_.degenerate > 0.0 && uniform01() < opt_.degenerate;
+    }
+
+public:
+    explicit SceneGenerator(const SceneOptions& opt = {})
+        : opt_(opt), rng_(opt.seed), scale_(std::is_floating_point_v<T> ? opt.scale : 1.0) {
+        if (opt_.minSize < 1 || opt_.maxSize < opt_.minSize || opt_.extent < 0)
+            throw std::invalid_argument("bad scene options");
+        // Дальше всего от центра уходят вершины вырожденной трапеции
+        // (64 шага по u и один по нормали); все координаты должны помещаться в T
+        const double reach = (double(opt_.extent) + kMaxReach * double(opt_.maxSize)) * scale_;
+        if (!(reach <= double(std::numeric_limits<T>::max())))
+            throw std::invalid_argument("scene extent does not fit the coordinate type");
+        if (opt_.placement == Placement::Clustered)
+            for (size_t i = 0; i < std::max<size_t>(opt_.clusters, 1); ++i)
+                clusterCenters_.push_back({ uniformInt(-opt_.extent, opt_.extent),
+                                            uniformInt(-opt_.extent, opt_.extent) });
+    }
+
+    // Прямоугольник p, p+u, p+u+w, p+w, где w ⊥ u. Обычно w = t·(-b, a);
+    // почти вырожденный — длинная полоса шириной в один шаг решётки вдоль
+    // оси или диагонали
+    GeneratedFigure<T> rectangle() {
+        auto p = randomCenter();
+        Lattice u, w;
+        if (degenerate()) {
+            static constexpr Lattice dirs[4][2] = {
+                { { 1, 0 }, { 0, 1 } }, { { 0, 1 }, { -1, 0 } },
+                { { 1, 1 }, { -1, 1 } }, { { 1, -1 }, { 1, 1 } },
+            };
+            const auto& d = dirs[uniformInt(0, 3)];
+            long len = uniformInt(opt_.maxSize * 4, opt_.maxSize * 16);
+            u = { d[0].x * len, d[0].y * len };
+            w = d[1];
+        } else {
+            u = randomVector(opt_.minSize, opt_.maxSize);
+            long t = uniformInt(1, 4);
+            w = { -t * u.y, t * u.x };
+        }
+        const Lattice v[4] = { p, { p.x + u.x, p.y + u.y },
+                               { p.x + u.x + w.x, p.y + u.y + w.y },
+                               { p.x + w.x, p.y + w.y } };
+        return finish<Rectangle<T>>(v);
+    }
+
+    // Ромб, проходящий проверку на вписанность, — квадрат со стороной u
+    GeneratedFigure<T> rhombus() {
+        auto p = randomCenter();
+        Lattice u = degenerate() ? Lattice{ 1, 0 } : randomVector(opt_.minSize, opt_.maxSize);
+        const Lattice v[4] = { p, { p.x + u.x, p.y + u.y },
+                               { p.x + u.x - u.y, p.y + u.y + u.x },
+                               { p.x - u.y, p.y + u.x } };
+        return finish<Rhombus<T>>(v);
+    }
+
+    // Равнобедренная трапеция, симметричная относительно оси через c:
+    // основания c ± l1·u и c + h·n ± l2·u
+    GeneratedFigure<T> trapezoid() {
+        auto c = randomCenter();
+        Lattice u = randomVector(opt_.minSize, opt_.maxSize);
+        long l1, l2, h;
+        if (degenerate()) {
+            l1 = uniformInt(8, 64);
+            l2 = l1 - 1;      // низкая, почти прямоугольная: основания много больше высоты
+            h = 1;
+        } else {
+            l1 = uniformInt(1, 4);
+            l2 = uniformInt(1, 4);
+            h = uniformInt(1, 4);
+        }
+        const Lattice n{ -u.y, u.x };
+        const Lattice v[4] = { { c.x - l1 * u.x, c.y - l1 * u.y },
+                               { c.x + l1 * u.x, c.y + l1 * u.y },
+                               { c.x + l2 * u.x + h * n.x, c.y + l2 * u.y + h * n.y },
+                               { c.x - l2 * u.x + h * n.x, c.y - l2 * u.y + h * n.y } };
+        return finish<Trapezoid<T>>(v);
+    }
+
+    // Случайный вид с учётом весов
+    GeneratedFigure<T> next() {
+        double total = opt_.rectangleWeight + opt_.rhombusWeight + opt_.trapezoidWeight;
+        double r = uniform01() * total;
+        if (r < opt_.rectangleWeight) return rectangle();
+        if (r < opt_.rectangleWeight + opt_.rhombusWeight) return rhombus();
+        return trapezoid();
+    }
+
+    Array<std::shared_ptr<Figure<T>>> scene(size_t n) {
+        Array<std::shared_ptr<Figure<T>>> arr;
+        for (size_t i = 0; i < n; ++i) arr.push_back(next().figure);
+        return arr;
+    }
+};
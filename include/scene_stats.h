@@ -0,0 +1,204 @@
+#pragma once
+#include "concepts.h"
+#include "point.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+// --- Сумма с компенсацией (алгоритм Ноймайера) ---
+// Вычитание — это добавление отрицательного значения, погрешность
+// не накапливается при длинных последовательностях вставок и удалений.
+class CompensatedSum {
+private:
+    double sum_{0.0};
+    double comp_{0.0};
+
+public:
+    void add(double x) {
+        double t = sum_ + x;
+        if (std::abs(sum_) >= std::abs(x)) comp_ += (sum_ - t) + x;
+        else comp_ += (x - t) + sum_;
+        sum_ = t;
+    }
+
+    double value() const { return sum_ + comp_; }
+    void reset() { sum_ = comp_ = 0.0; }
+};
+
+struct Bounds {
+    double minX{std::numeric_limits<double>::infinity()};
+    double minY{std::numeric_limits<double>::infinity()};
+    double maxX{-std::numeric_limits<double>::infinity()};
+    double maxY{-std::numeric_limits<double>::infinity()};
+
+    bool empty() const { return minX > maxX; }
+
+    void extend(const Bounds& o) {
+        minX = std::min(minX, o.minX);
+        minY = std::min(minY, o.minY);
+        maxX = std::max(maxX, o.maxX);
+        maxY = std::max(maxY, o.maxY);
+    }
+
+    // Касается ли o границы этого прямоугольника
+    bool touches(const Bounds& o) const {
+        return o.minX <= minX || o.minY <= minY || o.maxX >= maxX || o.maxY >= maxY;
+    }
+};
+
+// --- Сводка по одной фигуре: всё, что нужно для O(1) обновления агрегатов ---
+struct FigureSummary {
+    const char* kind{""};
+    double area{0.0};
+    double momentX{0.0};    // area * centroid.x
+    double momentY{0.0};    // area * centroid.y
+    Bounds box;
+};
+
+// Площадь и моменты по формуле шнурков, без деления на площадь,
+// чтобы вырожденные фигуры давали нулевой вклад
+template <HasVertices F>
+FigureSummary summarize(const F& f) {
+    FigureSummary s;
+    s.kind = f.name();
+    const size_t n = f.vertexCount();
+    if (n == 0) return s;
+
+    double a2 = 0.0, mx = 0.0, my = 0.0;
+    auto prev = f.vertex(n - 1);
+    for (size_t i = 0; i < n; ++i) {
+        auto cur = f.vertex(i);
+        double px = double(prev.x), py = double(prev.y);
+        double cx = double(cur.x), cy = double(cur.y);
+        double cr = px * cy - cx * py;
+        a2 += cr;
+        mx += (px + cx) * cr;
+        my += (py + cy) * cr;
+        s.box.extend({ cx, cy, cx, cy });
+        prev = cur;
+    }
+    double sign = a2 < 0 ? -1.0 : 1.0;
+    s.area = std::abs(a2) / 2.0;
+    s.momentX = sign * mx / 6.0;
+    s.momentY = sign * my / 6.0;
+    return s;
+}
+
+// --- Инкрементальные агрегаты сцены ---
+// add/remove выполняются за O(1) (число видов фигур мало). Ограничивающий
+// прямоугольник при удалении фигуры с его границы помечается устаревшим и
+// пересчитывается владельцем (Array) при следующем запросе.
+class SceneStats {
+public:
+    struct KindStats {
+        const char* kind;
+        size_t count{0};
+        CompensatedSum area;
+    };
+
+private:
+    size_t count_{0};
+    CompensatedSum area_;
+    CompensatedSum momentX_;
+    CompensatedSum momentY_;
+    Bounds box_;
+    bool boxStale_{false};
+    std::vector<KindStats> kinds_;
+
+    KindStats& kindEntry(const char* kind) {
+        for (auto& k : kinds_)
+            if (k.kind == kind || std::strcmp(k.kind, kind) == 0) return k;
+        kinds_.push_back(KindStats{ kind, 0, {} });
+        return kinds_.back();
+    }
+
+public:
+    void add(const FigureSummary& s) {
+        ++count_;
+        area_.add(s.area);
+        momentX_.add(s.momentX);
+        momentY_.add(s.momentY);
+        if (!boxStale_) box_.extend(s.box);
+        auto& k = kindEntry(s.kind);
+        ++k.count;
+        k.area.add(s.area);
+    }
+
+    void remove(const FigureSummary& s) {
+        if (--count_ == 0) {
+            reset();
+            return;
+        }
+        area_.add(-s.area);
+        momentX_.add(-s.momentX);
+        momentY_.add(-s.momentY);
+        if (box_.touches(s.box)) boxStale_ = true;
+        auto& k = kindEntry(s.kind);
+        if (--k.count == 0) k.area.reset();
+        else k.area.add(-s.area);
+    }
+
+    void reset() {
+        count_ = 0;
+        area_.reset();
+        momentX_.reset();
+        momentY_.reset();
+        box_ = {};
+        boxStale_ = false;
+        kinds_.clear();
+    }
+
+    // --- Пересчёт ограничивающего прямоугольника ---
+    bool boundsStale() const { return boxStale_; }
+
+    template <class Fn>
+    void rebuildBounds(size_t n, Fn summaryAt) {
+        box_ = {};
+        for (size_t i = 0; i < n; ++i) box_.extend(summaryAt(i).box);
+        boxStale_ = false;
+    }
+
+    // --- Доступ ---
+    size_t count() const { return count_; }
+    double totalArea() const { return area_.value(); }
+    double meanArea() const { return count_ ? totalArea() / double(count_) : 0.0; }
+    const Bounds& bounds() const { return box_; }
+    const std::vector<KindStats>& kinds() const { return kinds_; }
+
+    size_t count(const char* kind) const {
+        for (const auto& k : kinds_)
+            if (std::strcmp(k.kind, kind) == 0) return k.count;
+        return 0;
+    }
+
+    double area(const char* kind) const {
+        for (const auto& k : kinds_)
+            if (std::strcmp(k.kind, kind) == 0) return k.area.value();
+        return 0.0;
+    }
+
+    // Центр масс сцены (площадь — вес); для нулевой площади — (0, 0)
+    Point<double> centroid() const {
+        double a = totalArea();
+        if (a == 0.0) return {};
+        return { momentX_.value() / a, momentY_.value() / a };
+    }
+};
+
+inline std::ostream& operator<<(std::ostream& os, const SceneStats& s) {
+    os << "count = " << s.count() << ", total area = " << s.totalArea()
+       << ", mean area = " << s.meanArea() << "\n";
+    if (s.count()) {
+        const auto& b = s.bounds();
+        auto c = s.centroid();
+        os << "bounds = (" << b.minX << ", " << b.minY << ") - (" << b.maxX << ", " << b.maxY << ")\n";
+        os << "centroid = (" << c.x << ", " << c.y << ")\n";
+    }
+    for (const auto& k : s.kinds())
+        if (k.count) os << k.kind << ": count = " << k.count << ", area = " << k.area.value() << "\n";
+    return os;
+}
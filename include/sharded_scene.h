@@ -0,0 +1,417 @@
+#pragma once
+#include "concepts.h"
+#include "figure.h"
+#include "figure_array.h"
+#include "figure_io.h"
+#include "scene_stats.h"
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// --- Шардирование сцены по локальным процессам (Linux/POSIX) ---
+//
+// Координатор запускает workers дочерних процессов через fork() и общается
+// с каждым по паре Unix-сокетов (socketpair). Фигуры передаются в бинарном
+// формате figure_io.h, каждый процесс хранит свою часть в Array.
+//
+// Разбиение:
+//   Cell — по ячейке сетки cellSize x cellSize, в которую попал центр фигуры
+//          (запросы по прямоугольнику идут только в шарды нужных ячеек);
+//   Hash — по хешу порядкового номера фигуры (равномерная загрузка).
+//
+// Запросы рассылаются всем нужным шардам сразу, затем собираются ответы,
+// поэтому процессы работают параллельно. Добавления буферизуются и
+// отправляются пачками перед следующим запросом.
+//
+// Создавать объект следует до запуска потоков в процессе (ограничение fork).
+
+enum class ShardBy {
+    Cell,
+    Hash,
+};
+
+template <Scalar T>
+class ShardedScene {
+public:
+    // Предикат для eraseIf. Передаётся в процесс как адрес функции: это
+    // корректно, потому что процессы созданы fork() без exec() и имеют тот же
+    // образ памяти. Лямбды с захватом не поддерживаются.
+    using Predicate = bool (*)(const Figure<T>&);
+
+private:
+    enum class Op : std::uint8_t {
+        Add = 1,
+        Size,
+        TotalArea,
+        CountInBox,
+        QueryBox,
+        EraseIf,
+        Quit,
+    };
+
+    struct Worker {
+        pid_t pid{-1};
+        int fd{-1};
+        std::string pending;     // закодированные, ещё не отправленные фигуры
+    };
+
+    static constexpr size_t kFlushBytes = 1 << 16;
+    static constexpr long kMaxPrunedCells = 4096;
+
+    ShardBy mode_;
+    double cellSize_;
+    std::vector<Worker> workers_;
+    std::uint64_t next_{0};
+    bool broken_{false};     // обмен с шардом прервался: состояние неизвестно
+
+    // --- Обмен сообщениями: op (1 байт), длина (8 байт), данные ---
+    static void writeAll(int fd, const void* p, size_t n) {
+        auto c = static_cast<const char*>(p);
+        while (n) {
+            ssize_t w = ::send(fd, c, n, MSG_NOSIGNAL);
+            if (w < 0) {
+                if (errno == EINTR) continue;
+                throw std::system_error(errno, std::generic_category(), "shard send");
+            }
+            c += w;
+            n -= size_t(w);
+        }
+    }
+
+    // false — собеседник закрыл соединение до начала сообщения
+    static bool readAll(int fd, void* p, size_t n) {
+        auto c = static_cast<char*>(p);
+        size_t got = 0;
+        while (got < n) {
+            ssize_t r = ::read(fd, c + got, n - got);
+            if (r < 0) {
+                if (errno == EINTR) continue;
+                throw std::system_error(errno, std::generic_category(), "shard read");
+            }
+            if (r == 0) {
+                if (got == 0) return false;
+                throw std::runtime_error("shard connection closed mid-message");
+            }
+            got += size_t(r);
+        }
+        return true;
+    }
+
+    static void sendMsg(int fd, Op op, const std::string& payload = {}) {
+        char head[9];
+        head[0] = static_cast<char>(op);
+        std::uint64_t len = payload.size();
+        std::memcpy(head + 1, &len, sizeof(len));
+        writeAll(fd, head, sizeof(head));
+        if (len) writeAll(fd, payload.data(), payload.size());
+    }
+
+    static bool recvMsg(int fd, Op& op, std::string& payload) {
+        char head[9];
+        if (!readAll(fd, head, sizeof(head))) return false;
+        op = static_cast<Op>(head[0]);
+        std::uint64_t len;
+        std::memcpy(&len, head + 1, sizeof(len));
+        payload.resize(len);
+        if (len && !readAll(fd, payload.data(), len))
+            throw std::runtime_error("shard connection closed mid-message");
+        return true;
+    }
+
+    template <class V>
+    static std::string pack(const V& v) {
+        return std::string(reinterpret_cast<const char*>(&v), sizeof(v));
+    }
+
+    template <class V>
+    static V unpack(const std::string& s) {
+        if (s.size() != sizeof(V)) throw std::runtime_error("bad shard reply");
+        V v;
+        std::memcpy(&v, s.data(), sizeof(V));
+        return v;
+    }
+
+    // --- Процесс-шард ---
+    [[noreturn]] static void workerMain(int fd) {
+        auto pool = std::make_shared<VertexPool<T>>();
+        Array<std::shared_ptr<Figure<T>>> figs;
+        Op op;
+        std::string msg;
+        try {
+            while (recvMsg(fd, op, msg)) {
+                if (op == Op::Quit) break;
+                switch (op) {
+                    case Op::Add: {
+                        std::istringstream in(msg);
+                        readBinaryAll<T>(in, figs, pool);
+                        break;
+                    }
+                    case Op::Size:
+                        sendMsg(fd, op, pack(std::uint64_t(figs.size())));
+                        break;
+                    case Op::TotalArea:
+                        sendMsg(fd, op, pack(figs.trackedArea()));
+                        break;
+                    case Op::CountInBox:
+                    case Op::QueryBox: {
+                        auto b = unpack<Bounds>(msg);
+                        std::uint64_t count = 0;
+                        std::string out;
+                        for (size_t i = 0; i < figs.size(); ++i) {
+                            auto c = figs[i]->center();
+                            // Положительная проверка, как в parallelQuery: NaN в границах не совпадает ни с чем
+                            if (!(c.x >= b.minX && c.x <= b.maxX && c.y >= b.minY && c.y <= b.maxY)) continue;
+                            ++count;
+                            if (op == Op::QueryBox) appendBinary(out, *figs[i]);
+                        }
+                        sendMsg(fd, op, op == Op::QueryBox ? out : pack(count));
+                        break;
+                    }
+                    case Op::EraseIf: {
+                        auto pred = reinterpret_cast<Predicate>(unpack<std::uintptr_t>(msg));
+                        std::uint64_t removed = figs.eraseIf([pred](const std::shared_ptr<Figure<T>>& f) {
+                            return pred(*f);
+                        });
+                        sendMsg(fd, op, pack(removed));
+                        break;
+                    }
+                    default:
+                        throw std::runtime_error("unknown shard op");
+                }
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "shard " << ::getpid() << ": " << e.what() << "\n";
+            ::_exit(1);
+        }
+        ::_exit(0);
+    }
+
+    // --- Маршрутизация ---
+    static std::uint64_t mix(std::uint64_t x) {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    size_t shardOfCell(long cx, long cy) const {
+        return mix(std::uint64_t(cx) * 0x100000001b3ULL ^ std::uint64_t(cy)) % workers_.size();
+    }
+
+    // Номер ячейки; false, если он не представим в long (inf, NaN, огромные
+    // координаты) — тогда фигура уходит в шард 0, а запрос — во все шарды
+    bool cellOf(double v, long& cell) const {
+        const double c = std::floor(v / cellSize_);
+        if (!std::isfinite(c) || c < -0x1p63 || c >= 0x1p63) return false;
+        cell = static_cast<long>(c);
+        return true;
+    }
+
+    size_t route(const Figure<T>& f) {
+        if (mode_ == ShardBy::Hash) return mix(next_++) % workers_.size();
+        auto c = f.center();
+        long cx, cy;
+        if (!cellOf(double(c.x), cx) || !cellOf(double(c.y), cy)) return 0;
+        return shardOfCell(cx, cy);
+    }
+
+    // Шарды, которые могут содержать центры из прямоугольника
+    std::vector<bool> shardsFor(const Bounds& b) const {
+        std::vector<bool> use(workers_.size(), true);
+        if (mode_ != ShardBy::Cell) return use;
+        long x0, x1, y0, y1;
+        if (!cellOf(b.minX, x0) || !cellOf(b.maxX, x1) || !cellOf(b.minY, y0) || !cellOf(b.maxY, y1))
+            return use;
+        if ((double(x1) - double(x0) + 1) * (double(y1) - double(y0) + 1) > double(kMaxPrunedCells))
+            return use;
+        use.assign(workers_.size(), false);
+        for (long x = x0; x <= x1; ++x)
+            for (long y = y0; y <= y1; ++y) use[shardOfCell(x, y)] = true;
+        return use;
+    }
+
+    void checkAlive() const {
+        if (broken_) throw std::runtime_error("sharded scene is broken after a failed exchange");
+    }
+
+    void flush(Worker& w) {
+        if (w.pending.empty()) return;
+        checkAlive();
+        try {
+            sendMsg(w.fd, Op::Add, w.pending);
+        } catch (...) {
+            broken_ = true;
+            throw;
+        }
+        w.pending.clear();
+    }
+
+    // Рассылка запроса выбранным шардам и сбор ответов по порядку. Если обмен
+    // прервался на полпути, часть ответов осталась непрочитанной и протокол
+    // рассинхронизирован, поэтому объект помечается сломанным: все следующие
+    // операции бросают исключение.
+    std::vector<std::string> fanOut(Op op, const std::string& payload, const std::vector<bool>& use) {
+        flush();
+        checkAlive();
+        std::vector<std::string> replies(workers_.size());
+        try {
+            for (size_t i = 0; i < workers_.size(); ++i)
+                if (use[i]) sendMsg(workers_[i].fd, op, payload);
+            for (size_t i = 0; i < workers_.size(); ++i) {
+                if (!use[i]) continue;
+                Op got;
+                if (!recvMsg(workers_[i].fd, got, replies[i]) || got != op)
+                    throw std::runtime_error("shard worker exited");
+            }
+        } catch (...) {
+            broken_ = true;
+            throw;
+        }
+        return replies;
+    }
+
+    std::vector<std::string> fanOut(Op op, const std::string& payload = {}) {
+        return fanOut(op, payload, std::vector<bool>(workers_.size(), true));
+    }
+
+    void shutdown() noexcept {
+        for (auto& w : workers_) {
+            if (w.fd >= 0) {
+                try {
+                    sendMsg(w.fd, Op::Quit);
+                } catch (...) {
+                }
+                ::close(w.fd);
+                w.fd = -1;
+            }
+        }
+        for (auto& w : workers_) {
+            if (w.pid > 0) {
+                int status;
+                while (::waitpid(w.pid, &status, 0) < 0 && errno == EINTR) {}
+                w.pid = -1;
+            }
+        }
+    }
+
+public:
+    explicit ShardedScene(unsigned workers, ShardBy mode = ShardBy::Cell, double cellSize = 256.0)
+        : mode_(mode), cellSize_(cellSize) {
+        if (workers == 0) throw std::invalid_argument("need at least one shard");
+        if (!(cellSize > 0.0)) throw std::invalid_argument("cell size must be positive");
+
+        workers_.reserve(workers);
+        for (unsigned i = 0; i < workers; ++i) {
+            int sv[2];
+            if (::socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+                int err = errno;
+                shutdown();
+                throw std::system_error(err, std::generic_category(), "socketpair");
+            }
+            std::cout.flush();
+            std::cerr.flush();
+            pid_t pid = ::fork();
+            if (pid < 0) {
+                int err = errno;
+                ::close(sv[0]);
+                ::close(sv[1]);
+                shutdown();
+                throw std::system_error(err, std::generic_category(), "fork");
+            }
+            if (pid == 0) {
+                ::close(sv[0]);
+                for (const auto& w : workers_) ::close(w.fd);
+                workerMain(sv[1]);
+            }
+            ::close(sv[1]);
+            workers_.push_back({ pid, sv[0], {} });
+        }
+    }
+
+    ~ShardedScene() { shutdown(); }
+
+    ShardedScene(const ShardedScene&) = delete;
+    ShardedScene& operator=(const ShardedScene&) = delete;
+
+    unsigned workers() const { return static_cast<unsigned>(workers_.size()); }
+
+    void push_back(const Figure<T>& f) {
+        checkAlive();
+        auto& w = workers_[route(f)];
+        appendBinary(w.pending, f);
+        if (w.pending.size() >= kFlushBytes) flush(w);
+    }
+
+    template <class Arr>
+    void insert(const Arr& figs) {
+        for (size_t i = 0; i < figs.size(); ++i) push_back(*figs[i]);
+    }
+
+    void flush() {
+        for (auto& w : workers_) flush(w);
+    }
+
+    std::vector<size_t> shardSizes() {
+        std::vector<size_t> res;
+        for (const auto& r : fanOut(Op::Size)) res.push_back(unpack<std::uint64_t>(r));
+        return res;
+    }
+
+    size_t size() {
+        size_t n = 0;
+        for (size_t s : shardSizes()) n += s;
+        return n;
+    }
+
+    double totalArea() {
+        CompensatedSum s;
+        for (const auto& r : fanOut(Op::TotalArea)) s.add(unpack<double>(r));
+        return s.value();
+    }
+
+    // Число фигур, центр которых лежит в [x0, x1] x [y0, y1]
+    size_t countInBox(double x0, double y0, double x1, double y1) {
+        Bounds b{ x0, y0, x1, y1 };
+        auto use = shardsFor(b);
+        size_t n = 0;
+        auto replies = fanOut(Op::CountInBox, pack(b), use);
+        for (size_t i = 0; i < replies.size(); ++i)
+            if (use[i]) n += unpack<std::uint64_t>(replies[i]);
+        return n;
+    }
+
+    // Сами фигуры с центром в прямоугольнике (порядок — по шардам).
+    // Вершины многоугольников кладутся в pool; по умолчанию — в новый пул
+    // результата, который освобождается вместе с его фигурами.
+    Array<std::shared_ptr<Figure<T>>> queryBox(double x0, double y0, double x1, double y1,
+                                               std::shared_ptr<VertexPool<T>> pool = nullptr) {
+        if (!pool) pool = std::make_shared<VertexPool<T>>();
+        Bounds b{ x0, y0, x1, y1 };
+        auto use = shardsFor(b);
+        Array<std::shared_ptr<Figure<T>>> res;
+        for (const auto& r : fanOut(Op::QueryBox, pack(b), use)) {
+            std::istringstream in(r);
+            readBinaryAll<T>(in, res, pool);
+        }
+        return res;
+    }
+
+    size_t eraseIf(Predicate pred) {
+        size_t n = 0;
+        for (const auto& r : fanOut(Op::EraseIf, pack(reinterpret_cast<std::uintptr_t>(pred))))
+            n += unpack<std::uint64_t>(r);
+        return n;
+    }
+};
@@ -1,6 +1,8 @@
 #pragma once
 #include "concepts.h"
 #include "figure.h"
+#include "geometry.h"
+#include <array>
 #include <memory>
 #include <cmath>
 #include <iostream>
@@ -11,14 +13,8 @@ class Trapezoid : public Figure<T> {
 private:
     std::unique_ptr<Point<T>> a, b, c, d;
 
-    static double tri_area(const Point<T>& p1, const Point<T>& p2, const Point<T>& p3) {
-        return std::abs((p1.x * (p2.y - p3.y) +
-                         p2.x * (p3.y - p1.y) +
-                         p3.x * (p1.y - p2.y)) / 2.0);
-    }
-
-    static double dist(const Point<T>& p, const Point<T>& q) {
-        return std::sqrt((p.x - q.x) * (p.x - q.x) + (p.y - q.y) * (p.y - q.y));
+    std::array<Point<T>, 4> points() const {
+        return { *a, *b, *c, *d };
     }
 
     void validate() const {
@@ -43,17 +39,23 @@ private:
         double leg1, leg2;
         if (ab_parallel_cd) {
             // AB || CD => боковые стороны BC и AD
-            leg1 = dist(*b, *c);
-            leg2 = dist(*a, *d);
+            leg1 = pointDist(*b, *c);
+            leg2 = pointDist(*a, *d);
         } else {
             // BC || AD => боковые стороны AB и CD  
-            leg1 = dist(*a, *b);
-            leg2 = dist(*c, *d);
+            leg1 = pointDist(*a, *b);
+            leg2 = pointDist(*c, *d);
         }
 
         if (std::abs(leg1 - leg2) > 1e-6) {
             throw std::logic_error("Not an isosceles trapezoid");
         }
+
+        // Самопересекающийся четырёхугольник с параллельными сторонами — не трапеция
+        auto p = points();
+        if (!isConvexPolygon(p.data(), p.size())) {
+            throw std::logic_error("Not a trapezoid (not convex)");
+        }
     }
 
 public:
@@ -102,17 +104,33 @@ public:
     }
 
     Point<T> center() const override {
-        return (*a + *b + *c + *d) / 4.0;
+        auto p = points();
+        return vertexCenter(p.data(), p.size());
     }
 
     double area() const override {
-        return tri_area(*a, *b, *c) + tri_area(*a, *c, *d);
+        auto p = points();
+        return shoelaceArea(p.data(), p.size());
     }
 
     bool operator==(const Trapezoid& other) const {
         return *a == *other.a && *b == *other.b && *c == *other.c && *d == *other.d;
     }
 
+    const char* name() const override { return "Trapezoid"; }
+
+    size_t vertexCount() const override { return 4; }
+
+    Point<T> vertex(size_t i) const override {
+        switch (i) {
+            case 0: return *a;
+            case 1: return *b;
+            case 2: return *c;
+            case 3: return *d;
+        }
+        throw std::out_of_range("bad vertex index");
+    }
+
     std::unique_ptr<Figure<T>> clone() const override {
         return std::make_unique<Trapezoid<T>>(*this);
     }
@@ -5,9 +5,22 @@
 #include "rectangle.h"
 #include "rhombus.h"
 #include "trapezoid.h"
+#include "batch.h"
 
-int main() {
+int main(int argc, char** argv) {
     using D = double;
+
+    // Пакетный режим, если заданы аргументы командной строки
+    if (argc > 1) {
+        try {
+            return runBatch<D>(parseBatchArgs(argc, argv));
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            batchUsage(std::cerr);
+            return 1;
+        }
+    }
+
     Array<std::shared_ptr<Figure<D>>> figures;
 
     int choice;
@@ -19,6 +32,7 @@ int main() {
         std::cout << "5. print centers\n";
         std::cout << "6. total area\n";
         std::cout << "7. erase by index\n";
+        std::cout << "8. scene stats\n";
         std::cout << "0. exit\n> ";
         std::cin >> choice;
 
@@ -54,6 +68,8 @@ int main() {
             } catch (const std::exception& e) {
                 std::cerr << e.what() << "\n";
             }
+        } else if (choice == 8) {
+            std::cout << figures.stats();
         }
     }
 
@@ -5,6 +5,16 @@
 #include "rectangle.h"
 #include "rhombus.h"
 #include "trapezoid.h"
+#include "polygon.h"
+#include "packed_scene.h"
+#include "scene_generator.h"
+#include "sharded_scene.h"
+#include "figure_io.h"
+#include "batch.h"
+#include <sstream>
+#include <random>
+#include <cstdint>
+#include <limits>
 
 using D = double;
 
@@ -109,6 +119,21 @@ TEST(ArrayTest, TotalAreaWithDifferentFigures) {
     EXPECT_GT(total, 0.0);
 }
 
+TEST(ArrayTest, ErasedElementsAreReleased) {
+    auto keep = std::make_shared<Rectangle<D>>(Point<D>{0,0}, Point<D>{1,0}, Point<D>{1,1}, Point<D>{0,1});
+    auto drop = std::make_shared<Rectangle<D>>(Point<D>{0,0}, Point<D>{2,0}, Point<D>{2,2}, Point<D>{0,2});
+    Array<std::shared_ptr<Figure<D>>> arr;
+    arr.push_back(keep);
+    arr.push_back(drop);
+    EXPECT_EQ(arr.eraseIf([&](const std::shared_ptr<Figure<D>>& f) { return f == drop; }), 1u);
+    EXPECT_EQ(drop.use_count(), 1);
+
+    arr.push_back(drop);
+    arr.erase(1);
+    EXPECT_EQ(drop.use_count(), 1);
+    EXPECT_EQ(keep.use_count(), 2);
+}
+
 //
 // ---------- MAIN ----------
 //
@@ -191,3 +216,682 @@ TEST(FigureTest, AreasArePositive) {
     EXPECT_GT(Rh.area(), 0.0);
     EXPECT_GT(T.area(), 0.0);
 }
+
+//
+// ---------- FIGURE IO TESTS ----------
+//
+
+TEST(FigureIOTest, TextRoundTrip) {
+    std::istringstream in(
+        "# comment\n"
+        "rect 0 0 2 0 2 1 0 1\n"
+        "\n"
+        "rhombus 0 0 1 1 2 0 1 -1\n"
+        "trapezoid 0 0 4 0 3 1 1 1\n");
+    Array<std::shared_ptr<Figure<D>>> arr;
+    EXPECT_EQ(readText<D>(in, arr), 3u);
+    EXPECT_STREQ(arr[0]->name(), "Rectangle");
+    EXPECT_STREQ(arr[1]->name(), "Rhombus");
+    EXPECT_STREQ(arr[2]->name(), "Trapezoid");
+    EXPECT_NEAR(arr.totalArea(), 2.0 + 2.0 + 3.0, 1e-9);
+}
+
+TEST(FigureIOTest, BinaryRoundTrip) {
+    Array<std::shared_ptr<Figure<D>>> arr;
+    arr.push_back(std::make_shared<Rectangle<D>>(Point<D>{0,0}, Point<D>{2,0}, Point<D>{2,1}, Point<D>{0,1}));
+    arr.push_back(std::make_shared<Trapezoid<D>>(Point<D>{0,0}, Point<D>{4,0}, Point<D>{3,1}, Point<D>{1,1}));
+
+    std::stringstream buf;
+    for (size_t i = 0; i < arr.size(); ++i) writeBinary(buf, *arr[i]);
+
+    Array<std::shared_ptr<Figure<D>>> back;
+    EXPECT_EQ(readBinaryAll<D>(buf, back), 2u);
+    EXPECT_STREQ(back[1]->name(), "Trapezoid");
+    EXPECT_NEAR(back.totalArea(), arr.totalArea(), 1e-9);
+    EXPECT_TRUE(back[0]->vertex(2) == arr[0]->vertex(2));
+}
+
+TEST(FigureIOTest, TruncatedBinaryThrows) {
+    std::string rec;
+    appendBinary(rec, Rectangle<D>(Point<D>{0,0}, Point<D>{2,0}, Point<D>{2,1}, Point<D>{0,1}));
+
+    Array<std::shared_ptr<Figure<D>>> arr;
+    std::istringstream empty("");
+    EXPECT_EQ(readBinaryAll<D>(empty, arr), 0u);
+    std::istringstream halfHeader(rec.substr(0, 1));
+    EXPECT_THROW(readBinaryAll<D>(halfHeader, arr), std::runtime_error);
+    std::istringstream halfBody(rec + rec.substr(0, 5));
+    EXPECT_THROW(readBinaryAll<D>(halfBody, arr), std::runtime_error);
+}
+
+TEST(FigureIOTest, UnknownKindThrows) {
+    EXPECT_THROW(parseFigure<D>("circle 0 0 1"), std::invalid_argument);
+}
+
+TEST(BatchTest, FailedOpsAreCounted) {
+    Array<std::shared_ptr<Figure<D>>> arr;
+    BatchOptions opt;
+    BatchRunner<D> runner(opt, arr, std::make_shared<VertexPool<D>>());
+    runner.execute("add rect 0 0 2 0 2 1 0 1");
+    runner.execute("count");
+    EXPECT_EQ(runner.errors(), 0u);
+    runner.execute("erase 7");
+    runner.execute("frobnicate");
+    EXPECT_EQ(runner.errors(), 2u);
+    EXPECT_EQ(runner.takeOutput(), "count = 1\nerror: bad index\nerror: unknown op: frobnicate\n");
+}
+
+TEST(BatchTest, ParallelMatchesSerial) {
+    Array<std::shared_ptr<Figure<D>>> arr;
+    for (int i = 0; i < 100; ++i)
+        arr.push_back(std::make_shared<Rectangle<D>>(Point<D>{D(i),0}, Point<D>{D(i)+1,0}, Point<D>{D(i)+1,2}, Point<D>{D(i),2}));
+
+    EXPECT_NEAR(parallelTotalArea(arr, 4), arr.totalArea(), 1e-9);
+    auto hits = parallelQuery(arr, 4, 10.0, 0.0, 19.9, 2.0);
+    ASSERT_EQ(hits.size(), 10u);
+    EXPECT_EQ(hits.front(), 10u);
+    EXPECT_EQ(hits.back(), 19u);
+}
+
+//
+// ---------- FORMAT TESTS ----------
+//
+
+static std::string iostreamDump(const Array<std::shared_ptr<Figure<D>>>& arr) {
+    std::ostringstream os;
+    for (size_t i = 0; i < arr.size(); ++i)
+        os << i << ": " << *arr[i] << " Area = " << double(*arr[i]) << "\n";
+    return os.str();
+}
+
+TEST(FormatTest, TextMatchesIostream) {
+    Array<std::shared_ptr<Figure<D>>> arr;
+    arr.push_back(std::make_shared<Rectangle<D>>(Point<D>{0,0}, Point<D>{1.0/3,0}, Point<D>{1.0/3,1e-5}, Point<D>{0,1e-5}));
+    arr.push_back(std::make_shared<Rhombus<D>>(Point<D>{0,0}, Point<D>{1,1}, Point<D>{2,0}, Point<D>{1,-1}));
+    arr.push_back(std::make_shared<Trapezoid<D>>(Point<D>{-1e6,0}, Point<D>{3e6,0}, Point<D>{2e6,1.5}, Point<D>{0,1.5}));
+
+    std::ostringstream fast;
+    arr.printAll(fast);
+    EXPECT_EQ(fast.str(), iostreamDump(arr));
+}
+
+TEST(FormatTest, ParallelKeepsOrder) {
+    Array<std::shared_ptr<Figure<D>>> arr;
+    for (int i = 0; i < 70000; ++i)
+        arr.push_back(std::make_shared<Rectangle<D>>(Point<D>{D(i),0}, Point<D>{D(i)+1,0}, Point<D>{D(i)+1,1}, Point<D>{D(i),1}));
+
+    std::ostringstream serial, parallel;
+    arr.printCenters(serial);
+    arr.printCenters(parallel, DumpFormat::Text, 4);
+    EXPECT_EQ(serial.str(), parallel.str());
+}
+
+TEST(FormatTest, CsvAndJsonLines) {
+    Array<std::shared_ptr<Figure<D>>> arr;
+    arr.push_back(std::make_shared<Rectangle<D>>(Point<D>{0,0}, Point<D>{2,0}, Point<D>{2,0.5}, Point<D>{0,0.5}));
+
+    std::ostringstream csv, json, centers;
+    arr.printAll(csv, DumpFormat::Csv);
+    arr.printAll(json, DumpFormat::JsonLines);
+    arr.printCenters(centers, DumpFormat::JsonLines);
+    EXPECT_EQ(csv.str(), "index,kind,area,vertices\n0,Rectangle,1,\"0 0 2 0 2 0.5 0 0.5\"\n");
+    EXPECT_EQ(json.str(), "{\"index\":0,\"kind\":\"Rectangle\",\"area\":1,"
+                          "\"vertices\":[[0,0],[2,0],[2,0.5],[0,0.5]]}\n");
+    EXPECT_EQ(centers.str(), "{\"index\":0,\"x\":1,\"y\":0.25}\n");
+}
+
+//
+// ---------- POLYGON TESTS ----------
+//
+
+TEST(PolygonTest, TriangleAndHexagon) {
+    Triangle<D> t({ Point<D>{0,0}, Point<D>{4,0}, Point<D>{0,3} });
+    EXPECT_NEAR(t.area(), 6.0, 1e-9);
+    EXPECT_STREQ(t.name(), "Triangle");
+    auto c = t.center();
+    EXPECT_NEAR(c.x, 4.0 / 3, 1e-9);
+    EXPECT_NEAR(c.y, 1.0, 1e-9);
+
+    const double r = 2.0;
+    std::array<Point<D>, 6> hex;
+    for (size_t i = 0; i < 6; ++i)
+        hex[i] = Point<D>{ r * std::cos(i * M_PI / 3), r * std::sin(i * M_PI / 3) };
+    Hexagon<D> h(hex);
+    EXPECT_NEAR(h.area(), 3 * std::sqrt(3.0) / 2 * r * r, 1e-9);
+    EXPECT_EQ(h.vertexCount(), 6u);
+}
+
+TEST(PolygonTest, NonConvexThrows) {
+    using P5 = std::array<Point<D>, 5>;
+    EXPECT_THROW(Pentagon<D>(P5{ Point<D>{0,0}, Point<D>{4,0}, Point<D>{2,1}, Point<D>{4,4}, Point<D>{0,4} }),
+                 std::logic_error);
+    // Самопересекающаяся звезда: все повороты одного знака, но два оборота
+    P5 star;
+    for (size_t i = 0; i < 5; ++i)
+        star[i] = Point<D>{ std::cos(i * 4 * M_PI / 5), std::sin(i * 4 * M_PI / 5) };
+    EXPECT_THROW(Pentagon<D>{star}, std::logic_error);
+}
+
+TEST(PolygonTest, SharedKernelMatchesQuadrilaterals) {
+    Rectangle<D> r(Point<D>{0,0}, Point<D>{2,0}, Point<D>{2,1}, Point<D>{0,1});
+    PooledPolygon<D> p({ Point<D>{0,0}, Point<D>{2,0}, Point<D>{2,1}, Point<D>{0,1} });
+    EXPECT_NEAR(p.area(), r.area(), 1e-12);
+    EXPECT_TRUE(p.center() == r.center());
+    EXPECT_STREQ(p.name(), "Polygon");
+}
+
+TEST(PolygonTest, CenterDoesNotOverflowNarrowTypes) {
+    Rectangle<short> rs(Point<short>{20000,0}, Point<short>{20002,0}, Point<short>{20002,2}, Point<short>{20000,2});
+    EXPECT_EQ(rs.center().x, 20001);
+    EXPECT_EQ(rs.center().y, 1);
+
+    Rectangle<int> ri(Point<int>{2000000000,0}, Point<int>{2000000002,0},
+                      Point<int>{2000000002,2}, Point<int>{2000000000,2});
+    EXPECT_EQ(ri.center().x, 2000000001);
+    Triangle<int> t({ Point<int>{2000000000,0}, Point<int>{2000000003,0}, Point<int>{2000000000,3} });
+    EXPECT_EQ(t.center().x, 2000000001);
+}
+
+TEST(PolygonTest, BowtieTrapezoidThrows) {
+    EXPECT_THROW(
+        Trapezoid<D>(Point<D>{0,0}, Point<D>{4,0}, Point<D>{1,1}, Point<D>{3,1}),
+        std::logic_error
+    );
+}
+
+TEST(PolygonTest, PooledVerticesAreShared) {
+    auto pool = std::make_shared<VertexPool<D>>();
+    std::vector<Point<D>> hept;
+    for (size_t i = 0; i < 7; ++i)
+        hept.push_back(Point<D>{ std::cos(i * 2 * M_PI / 7), std::sin(i * 2 * M_PI / 7) });
+    PooledPolygon<D> a(hept, pool);
+    EXPECT_EQ(pool->size(), 7u);
+
+    auto c = a.clone();
+    EXPECT_EQ(pool->size(), 7u);
+    EXPECT_NEAR(c->area(), a.area(), 1e-12);
+
+    std::istringstream in("3 0 0 1 0 0 1");
+    a.read(in);
+    EXPECT_EQ(pool->size(), 10u);
+    EXPECT_EQ(a.vertexCount(), 3u);
+    EXPECT_EQ(c->vertexCount(), 7u);
+}
+
+TEST(PolygonTest, SmallScaleFiguresAccepted) {
+    EXPECT_NO_THROW(
+        Trapezoid<D>(Point<D>{0,0}, Point<D>{4e-5,0}, Point<D>{3e-5,1e-5}, Point<D>{1e-5,1e-5})
+    );
+    EXPECT_NO_THROW(
+        Rhombus<D>(Point<D>{0,0}, Point<D>{1e-5,1e-5}, Point<D>{2e-5,0}, Point<D>{1e-5,-1e-5})
+    );
+    EXPECT_NO_THROW(Triangle<D>({ Point<D>{0,0}, Point<D>{1e-6,0}, Point<D>{0,1e-6} }));
+    // Самопересекающаяся трапеция отклоняется и в малом масштабе
+    EXPECT_THROW(
+        Trapezoid<D>(Point<D>{0,0}, Point<D>{4e-5,0}, Point<D>{1e-5,1e-5}, Point<D>{3e-5,1e-5}),
+        std::logic_error
+    );
+}
+
+TEST(PolygonTest, CapitalizedNamesAndVertexLimit) {
+    auto t = parseFigure<D>("Triangle 0 0 4 0 0 3");
+    EXPECT_NE(dynamic_cast<Triangle<D>*>(t.get()), nullptr);
+    EXPECT_NEAR(t->area(), 6.0, 1e-12);
+    EXPECT_NE(dynamic_cast<Hexagon<D>*>(parseFigure<D>("Hexagon 0 0 2 0 3 1 2 2 0 2 -1 1").get()), nullptr);
+
+    // Число вершин проверяется до выделения памяти
+    EXPECT_THROW(parseFigure<D>("polygon 4000000000000 0 0"), std::invalid_argument);
+    EXPECT_THROW(parseFigure<D>("polygon 2 0 0 1 1"), std::invalid_argument);
+}
+
+TEST(PolygonTest, BatchUsesOwnPool) {
+    const size_t before = defaultVertexPool<D>()->size();
+    auto pool = std::make_shared<VertexPool<D>>();
+    std::istringstream in("polygon 4 0 0 1 0 1 1 0 1\n");
+    Array<std::shared_ptr<Figure<D>>> arr;
+    readText<D>(in, arr, pool);
+
+    BatchOptions opt;
+    BatchRunner<D> runner(opt, arr, pool);
+    runner.execute("add polygon 4 0 0 2 0 2 2 0 2");
+    runner.execute("count");
+    EXPECT_EQ(runner.takeOutput(), "count = 2\n");
+
+    EXPECT_EQ(pool->size(), 8u);
+    EXPECT_EQ(defaultVertexPool<D>()->size(), before);
+}
+
+TEST(PolygonTest, MixedArrayAndIO) {
+    std::istringstream in(
+        "triangle 0 0 4 0 0 3\n"
+        "rect 0 0 2 0 2 1 0 1\n"
+        "polygon 4 0 0 1 0 1 1 0 1\n"
+        "hexagon 0 0 2 0 3 1 2 2 0 2 -1 1\n");
+    Array<std::shared_ptr<Figure<D>>> arr;
+    EXPECT_EQ(readText<D>(in, arr), 4u);
+    EXPECT_NEAR(arr.totalArea(), 6.0 + 2.0 + 1.0 + 6.0, 1e-9);
+
+    std::stringstream buf;
+    for (size_t i = 0; i < arr.size(); ++i) writeBinary(buf, *arr[i]);
+    Array<std::shared_ptr<Figure<D>>> back;
+    EXPECT_EQ(readBinaryAll<D>(buf, back), 4u);
+    EXPECT_STREQ(back[0]->name(), "Triangle");
+    EXPECT_STREQ(back[3]->name(), "Hexagon");
+    EXPECT_NEAR(back.totalArea(), arr.totalArea(), 1e-9);
+
+    std::ostringstream fast;
+    arr.printAll(fast);
+    EXPECT_EQ(fast.str(), iostreamDump(arr));
+}
+
+//
+// ---------- SCENE STATS TESTS ----------
+//
+
+TEST(SceneStatsTest, BasicAggregates) {
+    Array<std::shared_ptr<Figure<D>>> arr;
+    arr.push_back(std::make_shared<Rectangle<D>>(Point<D>{0,0}, Point<D>{2,0}, Point<D>{2,1}, Point<D>{0,1}));
+    arr.push_back(std::make_shared<Rectangle<D>>(Point<D>{4,4}, Point<D>{6,4}, Point<D>{6,5}, Point<D>{4,5}));
+    arr.push_back(std::make_shared<Triangle<D>>(std::array<Point<D>, 3>{ Point<D>{0,0}, Point<D>{-3,0}, Point<D>{0,-3} }));
+
+    const auto& s = arr.stats();
+    EXPECT_EQ(s.count(), 3u);
+    EXPECT_EQ(s.count("Rectangle"), 2u);
+    EXPECT_EQ(s.count("Triangle"), 1u);
+    EXPECT_NEAR(s.totalArea(), 8.5, 1e-12);
+    EXPECT_NEAR(s.area("Triangle"), 4.5, 1e-12);
+    EXPECT_EQ(s.bounds().minX, -3.0);
+    EXPECT_EQ(s.bounds().maxY, 5.0);
+
+    // Удаление фигуры с границы — габариты пересчитываются
+    arr.erase(1);
+    EXPECT_EQ(arr.stats().bounds().maxY, 1.0);
+    EXPECT_EQ(arr.stats().bounds().maxX, 2.0);
+    auto c = arr.stats().centroid();
+    EXPECT_NEAR(c.x, (2.0 * 1.0 + 4.5 * -1.0) / 6.5, 1e-12);
+    EXPECT_NEAR(c.y, (2.0 * 0.5 + 4.5 * -1.0) / 6.5, 1e-12);
+
+    arr.clear();
+    EXPECT_EQ(arr.stats().count(), 0u);
+    EXPECT_EQ(arr.stats().totalArea(), 0.0);
+}
+
+TEST(SceneStatsTest, RandomizedMatchesRecompute) {
+    std::mt19937_64 rng(12345);
+    std::uniform_real_distribution<double> pos(-1e4, 1e4), size(1e-3, 50.0);
+    auto randomFigure = [&]() -> std::shared_ptr<Figure<D>> {
+        double x = pos(rng), y = pos(rng), w = size(rng), h = size(rng);
+        if (rng() % 2)
+            return std::make_shared<Rectangle<D>>(Point<D>{x,y}, Point<D>{x+w,y}, Point<D>{x+w,y+h}, Point<D>{x,y+h});
+        return std::make_shared<Triangle<D>>(std::array<Point<D>, 3>{ Point<D>{x,y}, Point<D>{x+w,y}, Point<D>{x,y+h} });
+    };
+
+    Array<std::shared_ptr<Figure<D>>> arr;
+    for (int step = 0; step < 20000; ++step) {
+        unsigned op = rng() % 100;
+        if (op < 55 || arr.empty()) {
+            arr.push_back(randomFigure());
+        } else if (op < 85) {
+            arr.erase(rng() % arr.size());
+        } else if (op < 92) {
+            arr.set(rng() % arr.size(), randomFigure());
+        } else if (op < 99) {
+            arr.modify(rng() % arr.size(), [&](std::shared_ptr<Figure<D>>& f) { f = randomFigure(); });
+        } else {
+            arr.clear();
+        }
+
+        if (step % 97 != 0 && step != 19999) continue;
+
+        const auto& s = arr.stats();
+        ASSERT_EQ(s.count(), arr.size());
+        double area = 0.0, mx = 0.0, my = 0.0;
+        size_t rects = 0;
+        Bounds box;
+        for (size_t i = 0; i < arr.size(); ++i) {
+            std::vector<Point<D>> v;
+            for (size_t k = 0; k < arr[i]->vertexCount(); ++k) {
+                v.push_back(arr[i]->vertex(k));
+                box.extend({ v.back().x, v.back().y, v.back().x, v.back().y });
+            }
+            double a = arr[i]->area();
+            auto c = areaCentroid(v.data(), v.size());
+            area += a;
+            mx += a * c.x;
+            my += a * c.y;
+            if (std::string(arr[i]->name()) == "Rectangle") ++rects;
+        }
+        EXPECT_EQ(s.count("Rectangle"), rects);
+        EXPECT_NEAR(s.totalArea(), area, 1e-9 * std::max(1.0, area));
+        if (!arr.empty()) {
+            EXPECT_EQ(s.bounds().minX, box.minX);
+            EXPECT_EQ(s.bounds().minY, box.minY);
+            EXPECT_EQ(s.bounds().maxX, box.maxX);
+            EXPECT_EQ(s.bounds().maxY, box.maxY);
+            EXPECT_NEAR(s.centroid().x, mx / area, 1e-6);
+            EXPECT_NEAR(s.centroid().y, my / area, 1e-6);
+        }
+    }
+}
+
+//
+// ---------- PACKED STORAGE TESTS ----------
+//
+
+template <class C>
+class PackedSceneTest : public ::testing::Test {};
+
+using PackedCoords = ::testing::Types<float, std::int16_t, std::int32_t>;
+TYPED_TEST_SUITE(PackedSceneTest, PackedCoords);
+
+TYPED_TEST(PackedSceneTest, ErrorBoundsHold) {
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> pos(-5e3, 5e3), size(0.01, 20.0);
+
+    Array<std::shared_ptr<Figure<D>>> arr;
+    for (int i = 0; i < 10000; ++i) {
+        double x = pos(rng), y = pos(rng), w = size(rng), h = size(rng);
+        if (i % 2)
+            arr.push_back(std::make_shared<Rectangle<D>>(Point<D>{x,y}, Point<D>{x+w,y}, Point<D>{x+w,y+h}, Point<D>{x,y+h}));
+        else
+            arr.push_back(std::make_shared<Triangle<D>>(std::array<Point<D>, 3>{ Point<D>{x,y}, Point<D>{x+w,y}, Point<D>{x,y+h} }));
+    }
+
+    auto packed = PackedScene<TypeParam>::from(arr, 1e-3);
+    ASSERT_EQ(packed.size(), arr.size());
+    for (size_t i = 0; i < arr.size(); ++i) {
+        auto a = packed.area(i);
+        EXPECT_LE(std::abs(a.value - arr[i]->area()), a.error);
+        auto c = packed.center(i);
+        auto exact = arr[i]->center();
+        EXPECT_LE(std::abs(c.value.x - exact.x), c.error);
+        EXPECT_LE(std::abs(c.value.y - exact.y), c.error);
+    }
+    auto total = packed.totalArea();
+    EXPECT_LE(std::abs(total.value - arr.totalArea()), total.error);
+    EXPECT_LT(packed.memoryBytes(), arr.size() * 64);
+}
+
+TEST(PackedSceneLayout, InterleavedClustersStayCompact) {
+    // Две группы дальше диапазона int16 друг от друга, фигуры вперемешку
+    Array<std::shared_ptr<Figure<D>>> arr;
+    for (int i = 0; i < 10000; ++i) {
+        double x = (i % 2 ? 1000.0 : -1000.0) + (i % 50) * 0.5, y = (i % 7) * 0.5;
+        arr.push_back(std::make_shared<Rectangle<D>>(Point<D>{x,y}, Point<D>{x+1,y}, Point<D>{x+1,y+1}, Point<D>{x,y+1}));
+    }
+    auto packed = PackedScene<std::int16_t>::from(arr, 1e-3);
+    EXPECT_LT(packed.memoryBytes(), arr.size() * 24);
+    EXPECT_NEAR(packed.totalArea().value, 10000.0, packed.totalArea().error);
+    EXPECT_NEAR(packed.center(1).value.x, 1001.0, packed.center(1).error);
+
+    // Фигура крупнее шага сетки (~32.8) хранится от своего центра, вдвое крупнее — нет
+    PackedScene<std::int16_t> big(1e-3);
+    big.push_back(Rectangle<D>(Point<D>{0,0}, Point<D>{50,0}, Point<D>{50,1}, Point<D>{0,1}));
+    EXPECT_NEAR(big.area(0).value, 50.0, big.area(0).error);
+    EXPECT_THROW(big.push_back(Rectangle<D>(Point<D>{0,0}, Point<D>{100,0}, Point<D>{100,1}, Point<D>{0,1})),
+                 std::out_of_range);
+    EXPECT_EQ(big.size(), 1u);
+}
+
+TEST(PackedSceneLayout, UnpackDoesNotGrowDefaultPool) {
+    auto src = std::make_shared<VertexPool<D>>();
+    std::vector<Point<D>> hept;
+    for (size_t i = 0; i < 7; ++i)
+        hept.push_back(Point<D>{ std::cos(i * 2 * M_PI / 7), std::sin(i * 2 * M_PI / 7) });
+    PackedScene<float> packed;
+    packed.push_back(PooledPolygon<D>(hept, src));
+    packed.push_back(Rectangle<D>(Point<D>{0,0}, Point<D>{2,0}, Point<D>{2,1}, Point<D>{0,1}));
+
+    const size_t before = defaultVertexPool<D>()->size();
+    auto one = packed.unpack(0);
+    EXPECT_EQ(one->vertexCount(), 7u);
+    auto pool = std::make_shared<VertexPool<D>>();
+    auto all = packed.toArray(pool);
+    EXPECT_EQ(all.size(), 2u);
+    EXPECT_EQ(pool->size(), 7u);
+    EXPECT_EQ(defaultVertexPool<D>()->size(), before);
+}
+
+TYPED_TEST(PackedSceneTest, UnpackKeepsKinds) {
+    Array<std::shared_ptr<Figure<D>>> arr;
+    arr.push_back(std::make_shared<Rectangle<D>>(Point<D>{0,0}, Point<D>{2,0}, Point<D>{2,1}, Point<D>{0,1}));
+    arr.push_back(std::make_shared<Rhombus<D>>(Point<D>{0,0}, Point<D>{1,1}, Point<D>{2,0}, Point<D>{1,-1}));
+    arr.push_back(std::make_shared<Trapezoid<D>>(Point<D>{0,0}, Point<D>{4,0}, Point<D>{3,1}, Point<D>{1,1}));
+    arr.push_back(std::make_shared<Hexagon<D>>(std::array<Point<D>, 6>{
+        Point<D>{0,0}, Point<D>{2,0}, Point<D>{3,1}, Point<D>{2,2}, Point<D>{0,2}, Point<D>{-1,1} }));
+
+    auto back = PackedScene<TypeParam>::from(arr, 0.5).toArray();
+    ASSERT_EQ(back.size(), 4u);
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT_STREQ(back[i]->name(), arr[i]->name());
+        EXPECT_NEAR(back[i]->area(), arr[i]->area(), 1e-9);
+    }
+}
+
+TEST(PackedSceneTest, Int16StartsNewChunkOutOfRange) {
+    PackedScene<std::int16_t> packed(1e-2);    // диапазон ±327 от начала блока
+    Rectangle<D> near(Point<D>{0,0}, Point<D>{1,0}, Point<D>{1,1}, Point<D>{0,1});
+    Rectangle<D> far(Point<D>{1e6,1e6}, Point<D>{1e6+1,1e6}, Point<D>{1e6+1,1e6+1}, Point<D>{1e6,1e6+1});
+    packed.push_back(near);
+    packed.push_back(far);
+    EXPECT_NEAR(packed.center(1).value.x, 1e6 + 0.5, packed.center(1).error);
+    EXPECT_NEAR(packed.area(0).value, 1.0, packed.area(0).error);
+
+    Rectangle<D> huge(Point<D>{0,0}, Point<D>{1e3,0}, Point<D>{1e3,1}, Point<D>{0,1});
+    EXPECT_THROW(packed.push_back(huge), std::out_of_range);
+    EXPECT_EQ(packed.size(), 2u);
+}
+
+//
+// ---------- PROPERTY TESTS (SceneGenerator) ----------
+//
+
+template <Scalar T>
+static bool sameFigure(const Figure<T>& a, const Figure<T>& b) {
+    if (auto r = dynamic_cast<const Rectangle<T>*>(&a))
+        if (auto o = dynamic_cast<const Rectangle<T>*>(&b)) return *r == *o;
+    if (auto r = dynamic_cast<const Rhombus<T>*>(&a))
+        if (auto o = dynamic_cast<const Rhombus<T>*>(&b)) return *r == *o;
+    if (auto r = dynamic_cast<const Trapezoid<T>*>(&a))
+        if (auto o = dynamic_cast<const Trapezoid<T>*>(&b)) return *r == *o;
+    return false;
+}
+
+template <class T>
+class GeneratedSceneTest : public ::testing::Test {
+protected:
+    static SceneOptions options(std::uint64_t seed, Placement placement) {
+        SceneOptions o;
+        o.seed = seed;
+        o.placement = placement;
+        o.degenerate = 0.2;
+        if constexpr (std::is_floating_point_v<T>) o.scale = 0.125;
+        return o;
+    }
+
+    // Целые T усекают центр при делении, вещественные — нет
+    static double centerTolerance(double v) {
+        if constexpr (std::is_integral_v<T>) return 1.0;
+        else return 1e-6 * std::max(1.0, std::abs(v));
+    }
+};
+
+using GeneratedScalars = ::testing::Types<short, int, long long, float, double>;
+TYPED_TEST_SUITE(GeneratedSceneTest, GeneratedScalars);
+
+TYPED_TEST(GeneratedSceneTest, AreaCenterCloneEquality) {
+    using T = TypeParam;
+    for (auto placement : { Placement::Uniform, Placement::Clustered }) {
+        SceneGenerator<T> gen(this->options(42, placement));
+        for (int i = 0; i < 2000; ++i) {
+            auto g = gen.next();
+            const auto& f = *g.figure;
+
+            EXPECT_NEAR(f.area(), g.area, 1e-9 * std::max(1.0, g.area));
+            EXPECT_GT(f.area(), 0.0);
+            auto c = f.center();
+            EXPECT_NEAR(double(c.x), g.center.x, this->centerTolerance(g.center.x));
+            EXPECT_NEAR(double(c.y), g.center.y, this->centerTolerance(g.center.y));
+
+            auto copy = f.clone();
+            EXPECT_STREQ(copy->name(), f.name());
+            EXPECT_EQ(double(*copy), f.area());
+            EXPECT_TRUE(sameFigure(*copy, f));
+
+            auto other = gen.next();
+            if (!(other.figure->vertex(0) == f.vertex(0))) {
+                EXPECT_FALSE(sameFigure(*other.figure, f));
+            }
+        }
+    }
+}
+
+TYPED_TEST(GeneratedSceneTest, SeedIsDeterministic) {
+    using T = TypeParam;
+    SceneGenerator<T> a(this->options(7, Placement::Clustered));
+    SceneGenerator<T> b(this->options(7, Placement::Clustered));
+    SceneGenerator<T> c(this->options(8, Placement::Clustered));
+    bool differs = false;
+    for (int i = 0; i < 200; ++i) {
+        auto fa = a.next().figure, fb = b.next().figure, fc = c.next().figure;
+        EXPECT_TRUE(sameFigure(*fa, *fb));
+        differs = differs || !sameFigure(*fa, *fc);
+    }
+    EXPECT_TRUE(differs);
+}
+
+TYPED_TEST(GeneratedSceneTest, ArrayOperations) {
+    using T = TypeParam;
+    SceneGenerator<T> gen(this->options(99, Placement::Uniform));
+    std::mt19937_64 rng(99);
+
+    Array<std::shared_ptr<Figure<T>>> arr;
+    std::vector<double> expected;
+    for (int step = 0; step < 3000; ++step) {
+        if (arr.empty() || rng() % 3) {
+            auto g = gen.next();
+            arr.push_back(g.figure);
+            expected.push_back(g.area);
+        } else {
+            size_t idx = rng() % arr.size();
+            arr.erase(idx);
+            expected.erase(expected.begin() + idx);
+        }
+    }
+
+    ASSERT_EQ(arr.size(), expected.size());
+    double sum = 0.0;
+    for (double a : expected) sum += a;
+    EXPECT_NEAR(arr.totalArea(), sum, 1e-9 * sum);
+    EXPECT_NEAR(arr.stats().totalArea(), sum, 1e-9 * sum);
+    EXPECT_EQ(arr.stats().count(), arr.size());
+
+    std::stringstream buf;
+    for (size_t i = 0; i < arr.size(); ++i) writeBinary(buf, *arr[i]);
+    Array<std::shared_ptr<Figure<T>>> back;
+    ASSERT_EQ(readBinaryAll<T>(buf, back), arr.size());
+    for (size_t i = 0; i < arr.size(); ++i)
+        EXPECT_TRUE(sameFigure(*back[i], *arr[i]));
+}
+
+TEST(GeneratedSceneLimits, ExtentMustFitCoordinateType) {
+    SceneOptions o;
+    o.extent = 100000;
+    EXPECT_THROW(SceneGenerator<short>{o}, std::invalid_argument);
+    EXPECT_NO_THROW(SceneGenerator<int>{o});
+    o.extent = 30000;
+    o.maxSize = 64;
+    EXPECT_THROW(SceneGenerator<short>{o}, std::invalid_argument);
+    o.maxSize = 16;
+    EXPECT_NO_THROW(SceneGenerator<short>{o});
+}
+
+//
+// ---------- SHARDED SCENE TESTS ----------
+//
+
+static bool largeFigure(const Figure<D>& f) {
+    return f.area() > 200.0;
+}
+
+TEST(ShardedSceneTest, MatchesLocalArray) {
+    SceneOptions opt;
+    opt.seed = 5;
+    opt.placement = Placement::Clustered;
+    opt.extent = 2000;
+    auto local = SceneGenerator<D>(opt).scene(5000);
+
+    for (auto mode : { ShardBy::Cell, ShardBy::Hash }) {
+        for (unsigned workers : { 1u, 3u }) {
+            ShardedScene<D> sharded(workers, mode, 100.0);
+            sharded.insert(local);
+
+            auto sizes = sharded.shardSizes();
+            ASSERT_EQ(sizes.size(), workers);
+            EXPECT_EQ(sharded.size(), local.size());
+            EXPECT_NEAR(sharded.totalArea(), local.totalArea(), 1e-9 * local.totalArea());
+
+            auto hits = parallelQuery(local, 1, -500.0, -300.0, 250.0, 800.0);
+            EXPECT_EQ(sharded.countInBox(-500.0, -300.0, 250.0, 800.0), hits.size());
+            auto found = sharded.queryBox(-500.0, -300.0, 250.0, 800.0);
+            EXPECT_EQ(found.size(), hits.size());
+            double area = 0.0;
+            for (size_t i : hits) area += local[i]->area();
+            EXPECT_NEAR(found.totalArea(), area, 1e-9 * std::max(1.0, area));
+
+            // Ячейки бесконечного прямоугольника не представимы — запрос идёт во все шарды
+            const double inf = std::numeric_limits<double>::infinity();
+            EXPECT_EQ(sharded.countInBox(-inf, -inf, inf, inf), local.size());
+            EXPECT_EQ(sharded.countInBox(-1e300, -1e300, 1e300, 1e300), local.size());
+        }
+    }
+}
+
+TEST(ShardedSceneTest, NaNBoundsMatchNothing) {
+    Array<std::shared_ptr<Figure<D>>> local;
+    local.push_back(std::make_shared<Rectangle<D>>(Point<D>{0,0}, Point<D>{1,0}, Point<D>{1,1}, Point<D>{0,1}));
+
+    ShardedScene<D> sharded(2, ShardBy::Cell, 100.0);
+    sharded.insert(local);
+    EXPECT_EQ(sharded.countInBox(0.0, 0.0, 1.0, 1.0), 1u);
+    EXPECT_EQ(sharded.countInBox(NAN, 0.0, 1.0, 1.0), parallelQuery(local, 1, NAN, 0.0, 1.0, 1.0).size());
+    EXPECT_EQ(sharded.countInBox(NAN, 0.0, 1.0, 1.0), 0u);
+    EXPECT_EQ(sharded.queryBox(0.0, 0.0, 1.0, NAN).size(), 0u);
+}
+
+TEST(ShardedSceneTest, QueryDoesNotGrowDefaultPool) {
+    auto pool = std::make_shared<VertexPool<D>>();
+    std::vector<Point<D>> hept;
+    for (size_t i = 0; i < 7; ++i)
+        hept.push_back(Point<D>{ std::cos(i * 2 * M_PI / 7), std::sin(i * 2 * M_PI / 7) });
+    PooledPolygon<D> p(hept, pool);
+
+    ShardedScene<D> sharded(2);
+    sharded.push_back(p);
+    const size_t before = defaultVertexPool<D>()->size();
+    auto found = sharded.queryBox(-1.0, -1.0, 1.0, 1.0);
+    ASSERT_EQ(found.size(), 1u);
+    EXPECT_NEAR(found[0]->area(), p.area(), 1e-12);
+    EXPECT_EQ(defaultVertexPool<D>()->size(), before);
+
+    auto own = std::make_shared<VertexPool<D>>();
+    EXPECT_EQ(sharded.queryBox(-1.0, -1.0, 1.0, 1.0, own).size(), 1u);
+    EXPECT_EQ(own->size(), 7u);
+}
+
+TEST(ShardedSceneTest, EraseIfByPredicate) {
+    SceneOptions opt;
+    opt.seed = 6;
+    auto local = SceneGenerator<D>(opt).scene(3000);
+
+    ShardedScene<D> sharded(4, ShardBy::Hash);
+    sharded.insert(local);
+
+    size_t removed = local.eraseIf([](const std::shared_ptr<Figure<D>>& f) { return largeFigure(*f); });
+    EXPECT_GT(removed, 0u);
+    EXPECT_EQ(sharded.eraseIf(&largeFigure), removed);
+    EXPECT_EQ(sharded.size(), local.size());
+    EXPECT_NEAR(sharded.totalArea(), local.totalArea(), 1e-9 * local.totalArea());
+    EXPECT_NEAR(local.trackedArea(), local.totalArea(), 1e-9 * local.totalArea());
+    EXPECT_NEAR(local.stats().totalArea(), local.totalArea(), 1e-9 * local.totalArea());
+}